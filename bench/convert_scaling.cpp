@@ -0,0 +1,112 @@
+// 多数のウィンドウを持つフレームを、逐次のconverterとparallel_converterで変換して比べる
+// スレッド数を1から順に増やし、逐次変換に対する速度向上を表示する
+//
+// 使い方: convert_scaling_bench [最大スレッド数] [ウィンドウ数]
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <thread>
+
+#include "nuklear-cpp.hpp"
+
+namespace {
+
+constexpr int repeat_count = 200;
+constexpr int round_count = 5;
+constexpr int target_width = 1920;
+constexpr int target_height = 1080;
+constexpr nk_flags window_flags = NK_WINDOW_BORDER | NK_WINDOW_MOVABLE | NK_WINDOW_TITLE;
+
+// ウィンドウごとにラベル、ボタン、スライダー、グラフを並べる
+void build(nk_context* ctx, int window_count) {
+    const int columns = 8;
+    const float w = static_cast<float>(target_width) / columns;
+    const float h = 180.0f;
+    for (int i = 0; i < window_count; ++i) {
+        const std::string title = "window " + std::to_string(i);
+        const struct nk_rect bounds = nk_rect((i % columns) * w, (i / columns % 6) * h, w - 4, h - 4);
+        if (nk::window win{ctx, title.c_str(), bounds, window_flags}) {
+            nk::row_dynamic(ctx, 18, 2);
+            nk_label(ctx, "value:", NK_TEXT_LEFT);
+            nk_button_label(ctx, "apply");
+            float value = static_cast<float>(i % 10) / 10.0f;
+            nk::row_dynamic(ctx, 18, 1);
+            nk_slider_float(ctx, 0.0f, &value, 1.0f, 0.01f);
+            nk::row_dynamic(ctx, 60, 1);
+            if (nk_chart_begin(ctx, NK_CHART_LINES, 32, -1.0f, 1.0f)) {
+                for (int j = 0; j < 32; ++j) {
+                    nk_chart_push(ctx, static_cast<float>((i * 7 + j * 3) % 20) / 10.0f - 1.0f);
+                }
+                nk_chart_end(ctx);
+            }
+        }
+    }
+}
+
+template <class Convert>
+double run(Convert convert) {
+    double best = 1e300;
+    for (int round = 0; round < round_count; ++round) {
+        const auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < repeat_count; ++i) {
+            convert();
+        }
+        const auto elapsed = std::chrono::steady_clock::now() - start;
+        best = std::min(best, std::chrono::duration<double, std::micro>(elapsed).count() / repeat_count);
+    }
+    return best;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    const unsigned hardware = std::max(1u, std::thread::hardware_concurrency());
+    const std::size_t max_threads = argc > 1 && std::atoi(argv[1]) > 0 ? std::atoi(argv[1]) : hardware;
+    const int window_count = argc > 2 && std::atoi(argv[2]) > 0 ? std::atoi(argv[2]) : 48;
+
+    nk::headless_context headless{target_width, target_height};
+    headless.input_begin();
+    headless.input_end();
+    build(headless.context(), window_count);
+    nk::command_list commands;
+    commands.capture(headless.context());
+    const nk::convert_options& options = headless.options();
+
+    nk::converter serial;
+    nk::draw_data expected;
+    serial.convert(commands, options, expected);
+    nk::framebuffer expected_image{target_width, target_height};
+    expected_image.clear(nk_color{0, 0, 0, 255});
+    nk::rasterize(expected, expected_image);
+
+    const double serial_us = run([&] { serial.convert(commands, options, expected); });
+    std::printf("windows          : %d\n", window_count);
+    std::printf("commands         : %zu\n", commands.size());
+    std::printf("vertices         : %zu\n", expected.vertices.size());
+    std::printf("serial           : %.1f us/frame\n", serial_us);
+
+    for (std::size_t threads = 1; threads <= max_threads; ++threads) {
+        nk::thread_pool pool{threads};
+        nk::parallel_converter parallel{pool};
+        nk::draw_data data;
+        parallel.convert(commands, options, data);
+
+        // 逐次変換と同じ画像になることを確認する
+        nk::framebuffer image{target_width, target_height};
+        image.clear(nk_color{0, 0, 0, 255});
+        nk::rasterize(data, image);
+        if (image.diff(expected_image) != 0) {
+            std::fprintf(stderr, "parallel convert with %zu threads differs from the serial result\n", threads);
+            return EXIT_FAILURE;
+        }
+
+        const double us = run([&] { parallel.convert(commands, options, data); });
+        std::printf("%2zu threads       : %.1f us/frame, %zu segments, speedup %.2fx\n",
+                    threads, us, parallel.segment_count(), serial_us / us);
+    }
+
+    nk_clear(headless.context());
+    return EXIT_SUCCESS;
+}
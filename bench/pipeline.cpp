@@ -0,0 +1,354 @@
+// フレームパイプラインの各段階(入力・UI構築・nk_convert・描画)を個別に計測する
+// 描画はヘッドレスバックエンドで行うのでディスプレイのない環境でも動く
+// 結果はJSONで標準出力に書き出す
+//
+// 使い方: nuklear_cpp_bench [計測フレーム数] [シナリオ名...]
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory_resource>
+#include <new>
+#include <string>
+#include <vector>
+
+#include "nuklear-cpp.hpp"
+
+// ヒープ確保回数を数えるためにグローバルなoperator newを置き換える
+namespace {
+std::atomic<std::size_t> heap_allocations{0};
+} // namespace
+
+void* operator new(std::size_t size) {
+    heap_allocations.fetch_add(1, std::memory_order_relaxed);
+    if (void* p = std::malloc(size == 0 ? 1 : size)) {
+        return p;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept {
+    std::free(p);
+}
+
+void operator delete(void* p, std::size_t) noexcept {
+    std::free(p);
+}
+
+namespace {
+
+constexpr int default_frame_count = 300;
+constexpr int warmup_frame_count = 30;
+constexpr int target_width = 1280;
+constexpr int target_height = 720;
+constexpr nk_flags window_flags =
+    NK_WINDOW_BORDER | NK_WINDOW_MOVABLE | NK_WINDOW_SCALABLE | NK_WINDOW_MINIMIZABLE | NK_WINDOW_TITLE;
+
+// Nuklearのアロケータ経由の確保回数を数える
+class counting_resource final : public std::pmr::memory_resource {
+public:
+    std::size_t allocations() const noexcept { return m_allocations; }
+
+private:
+    void* do_allocate(std::size_t bytes, std::size_t alignment) override {
+        ++m_allocations;
+        return std::pmr::new_delete_resource()->allocate(bytes, alignment);
+    }
+    void do_deallocate(void* p, std::size_t bytes, std::size_t alignment) override {
+        std::pmr::new_delete_resource()->deallocate(p, bytes, alignment);
+    }
+    bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override {
+        return this == &other;
+    }
+
+    std::size_t m_allocations = 0;
+};
+
+enum stage { INPUT, BUILD, CONVERT, SUBMIT, STAGE_COUNT };
+constexpr const char* stage_names[STAGE_COUNT] = {"input", "build", "convert", "submit"};
+
+struct stage_samples {
+    std::vector<double> ns;
+    std::size_t nk_allocations = 0;
+    std::size_t heap_allocations = 0;
+};
+
+// 入力はフレーム番号だけから決まるので、実行ごとに同じ結果になる
+void scripted_input(nk_context* ctx, int frame) {
+    const int x = 100 + (frame * 7) % 600;
+    const int y = 100 + (frame * 3) % 400;
+    nk_input_motion(ctx, x, y);
+    if (frame % 60 == 30) {
+        nk_input_button(ctx, NK_BUTTON_LEFT, x, y, nk_true);
+    } else if (frame % 60 == 31) {
+        nk_input_button(ctx, NK_BUTTON_LEFT, x, y, nk_false);
+    }
+    nk_input_scroll(ctx, nk_vec2(0.0f, (frame / 120) % 2 == 0 ? -1.0f : 1.0f));
+}
+
+// main_origin.cppのデモウィンドウ
+struct demo_scenario {
+    enum { EASY, HARD };
+    int op = EASY;
+    int property = 20;
+    nk_colorf bg{0.10f, 0.18f, 0.24f, 1.0f};
+
+    void build(nk_context* ctx) {
+        if (nk::window win{ctx, "Demo", nk_rect(50, 50, 230, 250), window_flags}) {
+            nk::row_static(ctx, 30, 80, 1);
+            nk_button_label(ctx, "button");
+            nk::row_dynamic(ctx, 30, 2);
+            if (nk_option_label(ctx, "easy", op == EASY)) op = EASY;
+            if (nk_option_label(ctx, "hard", op == HARD)) op = HARD;
+            nk::row_dynamic(ctx, 25, 1);
+            nk_property_int(ctx, "Compression:", 0, &property, 100, 10, 1);
+
+            nk::row_dynamic(ctx, 20, 1);
+            nk_label(ctx, "background:", NK_TEXT_LEFT);
+            nk::row_dynamic(ctx, 25, 1);
+            if (auto combo = nk::combo_color(ctx, nk_rgb_cf(bg), nk_vec2(nk_widget_width(ctx), 400))) {
+                nk::row_dynamic(ctx, 120, 1);
+                bg = nk_color_picker(ctx, bg, NK_RGBA);
+                nk::row_dynamic(ctx, 25, 1);
+                bg.r = nk_propertyf(ctx, "#R:", 0, bg.r, 1.0f, 0.01f, 0.005f);
+                bg.g = nk_propertyf(ctx, "#G:", 0, bg.g, 1.0f, 0.01f, 0.005f);
+                bg.b = nk_propertyf(ctx, "#B:", 0, bg.b, 1.0f, 0.01f, 0.005f);
+                bg.a = nk_propertyf(ctx, "#A:", 0, bg.a, 1.0f, 0.01f, 0.005f);
+            }
+        }
+    }
+};
+
+// 1万行のリスト。見えていない行もレイアウトは毎フレーム計算される
+struct list_scenario {
+    static constexpr int row_count = 10000;
+    std::vector<std::string> rows;
+
+    list_scenario() {
+        rows.reserve(row_count);
+        for (int i = 0; i < row_count; ++i) {
+            rows.push_back("row " + std::to_string(i) + ": the quick brown fox");
+        }
+    }
+
+    void build(nk_context* ctx) {
+        if (nk::window win{ctx, "List", nk_rect(20, 20, 400, 680), window_flags}) {
+            nk::row_dynamic(ctx, 18, 1);
+            for (const auto& row : rows) {
+                nk_label(ctx, row.c_str(), NK_TEXT_LEFT);
+            }
+        }
+    }
+};
+
+// 100万行のリストをnk::list_viewで作る。作るのは見えている行だけ
+struct virtual_list_scenario {
+    static constexpr std::size_t row_count = 1000000;
+    nk::list_view_state state;
+
+    void build(nk_context* ctx) {
+        if (nk::window win{ctx, "List", nk_rect(20, 20, 400, 680), window_flags}) {
+            nk::row_dynamic(ctx, 640, 1);
+            nk::list_view(ctx, state, "rows", 0, row_count, 18, [&](std::size_t row) {
+                char text[64];
+                std::snprintf(text, sizeof(text), "row %zu: the quick brown fox", row);
+                nk_label(ctx, text, NK_TEXT_LEFT);
+            });
+        }
+    }
+};
+
+// ノードエディタ風のキャンバス。格子、ノード、ノード間の曲線を直接描く
+struct node_editor_scenario {
+    static constexpr int node_count = 64;
+
+    void build(nk_context* ctx) {
+        if (nk::window win{ctx, "Node editor", nk_rect(0, 0, 1280, 720), NK_WINDOW_BORDER | NK_WINDOW_NO_SCROLLBAR}) {
+            nk_command_buffer* canvas = nk_window_get_canvas(ctx);
+            const struct nk_rect bounds = nk_window_get_content_region(ctx);
+            const nk_color grid{50, 50, 50, 255};
+            for (float x = 0; x < bounds.w; x += 32.0f) {
+                nk_stroke_line(canvas, bounds.x + x, bounds.y, bounds.x + x, bounds.y + bounds.h, 1.0f, grid);
+            }
+            for (float y = 0; y < bounds.h; y += 32.0f) {
+                nk_stroke_line(canvas, bounds.x, bounds.y + y, bounds.x + bounds.w, bounds.y + y, 1.0f, grid);
+            }
+            for (int i = 0; i < node_count; ++i) {
+                const struct nk_rect node = node_bounds(bounds, i);
+                nk_fill_rect(canvas, node, 4.0f, nk_color{60, 60, 70, 255});
+                nk_stroke_rect(canvas, node, 4.0f, 1.0f, nk_color{100, 100, 100, 255});
+                nk_fill_circle(canvas, nk_rect(node.x + node.w - 4, node.y + 20, 8, 8), nk_color{100, 200, 100, 255});
+                nk_draw_text(canvas, nk_rect(node.x + 6, node.y + 4, node.w - 12, 16), "node", 4,
+                             ctx->style.font, nk_color{0, 0, 0, 0}, nk_color{220, 220, 220, 255});
+                if (i + 1 < node_count) {
+                    const struct nk_rect next = node_bounds(bounds, i + 1);
+                    const float ax = node.x + node.w;
+                    const float ay = node.y + 24;
+                    const float bx = next.x;
+                    const float by = next.y + 24;
+                    nk_stroke_curve(canvas, ax, ay, ax + 50, ay, bx - 50, by, bx, by, 1.5f, nk_color{200, 200, 100, 255});
+                }
+            }
+        }
+    }
+
+    static struct nk_rect node_bounds(const struct nk_rect& bounds, int i) {
+        return nk_rect(bounds.x + 20 + (i % 8) * 155, bounds.y + 20 + (i / 8) * 85, 120, 60);
+    }
+};
+
+// 小さな円と角丸の多いウィジェットを格子状に並べる
+struct widget_grid_scenario {
+    static constexpr int row_count = 40;
+    int selected[row_count] = {};
+    float values[row_count] = {};
+
+    void build(nk_context* ctx) {
+        if (nk::window win{ctx, "Widgets", nk_rect(10, 10, 1260, 700), window_flags}) {
+            for (int i = 0; i < row_count; ++i) {
+                nk::row_dynamic(ctx, 22, 6);
+                for (int j = 0; j < 4; ++j) {
+                    if (nk_option_label(ctx, "option", selected[i] == j)) selected[i] = j;
+                }
+                nk_slider_float(ctx, 0.0f, &values[i], 1.0f, 0.01f);
+                nk_button_label(ctx, "apply");
+            }
+        }
+    }
+};
+
+// 同じ格子を、分割数を誤差0.25ピクセルから決めて変換する
+struct widget_grid_adaptive_scenario : widget_grid_scenario {
+    static constexpr float segment_tolerance = 0.25f;
+};
+
+// 折り返し付きの長い文章を大量に並べる
+struct text_scenario {
+    static constexpr int paragraph_count = 40;
+    std::string paragraph;
+
+    text_scenario() {
+        for (int i = 0; i < 12; ++i) {
+            paragraph += "Lorem ipsum dolor sit amet, consectetur adipiscing elit, sed do eiusmod tempor. ";
+        }
+    }
+
+    void build(nk_context* ctx) {
+        if (nk::window win{ctx, "Text", nk_rect(10, 10, 1260, 700), window_flags}) {
+            for (int i = 0; i < paragraph_count; ++i) {
+                nk::row_dynamic(ctx, 90, 1);
+                nk_label_wrap(ctx, paragraph.c_str());
+            }
+        }
+    }
+};
+
+double percentile(std::vector<double> values, double p) {
+    if (values.empty()) {
+        return 0.0;
+    }
+    const auto index = static_cast<std::size_t>(p * static_cast<double>(values.size() - 1) + 0.5);
+    std::nth_element(values.begin(), values.begin() + index, values.end());
+    return values[index];
+}
+
+template <class Scenario>
+void run(const char* name, int frame_count, bool first) {
+    counting_resource counter;
+    const nk_allocator allocator = nk::make_allocator(counter);
+    nk::headless_context headless{target_width, target_height, 13.0f, &allocator};
+    nk_context* ctx = headless.context();
+    Scenario scenario;
+    if constexpr (requires { Scenario::segment_tolerance; }) {
+        headless.options().segment_tolerance = Scenario::segment_tolerance;
+    }
+
+    stage_samples samples[STAGE_COUNT];
+    for (auto& s : samples) {
+        s.ns.reserve(frame_count);
+    }
+
+    using clock = std::chrono::steady_clock;
+    for (int frame = 0; frame < warmup_frame_count + frame_count; ++frame) {
+        const bool measured = frame >= warmup_frame_count;
+        clock::time_point begin = clock::now();
+        auto measure = [&](stage s, auto&& body) {
+            const std::size_t nk_before = counter.allocations();
+            const std::size_t heap_before = heap_allocations.load(std::memory_order_relaxed);
+            body();
+            const clock::time_point end = clock::now();
+            if (measured) {
+                samples[s].ns.push_back(std::chrono::duration<double, std::nano>(end - begin).count());
+                samples[s].nk_allocations += counter.allocations() - nk_before;
+                samples[s].heap_allocations += heap_allocations.load(std::memory_order_relaxed) - heap_before;
+            }
+            begin = end;
+        };
+
+        measure(INPUT, [&] {
+            headless.input_begin();
+            scripted_input(ctx, frame);
+            headless.input_end();
+        });
+        measure(BUILD, [&] { scenario.build(ctx); });
+        measure(CONVERT, [&] { headless.convert(); });
+        measure(SUBMIT, [&] { headless.submit(); });
+    }
+
+    std::printf("%s    {\"name\": \"%s\", \"frames\": %d, \"vertices\": %zu, \"indices\": %zu, \"draw_commands\": %zu, \"stages\": {",
+                first ? "" : ",\n", name, frame_count,
+                headless.last_draw_data().vertices.size(),
+                headless.last_draw_data().indices.size(),
+                headless.last_draw_data().commands.size());
+    for (int s = 0; s < STAGE_COUNT; ++s) {
+        std::printf("%s\"%s\": {\"p50_ns\": %.0f, \"p99_ns\": %.0f, \"nk_allocations\": %zu, \"heap_allocations\": %zu}",
+                    s == 0 ? "" : ", ", stage_names[s],
+                    percentile(samples[s].ns, 0.50), percentile(samples[s].ns, 0.99),
+                    samples[s].nk_allocations, samples[s].heap_allocations);
+    }
+    std::printf("}}");
+}
+
+struct scenario_entry {
+    const char* name;
+    void (*run)(const char* name, int frame_count, bool first);
+};
+
+constexpr scenario_entry scenarios[] = {
+    {"demo", run<demo_scenario>},
+    {"list_10k", run<list_scenario>},
+    {"list_1m_virtual", run<virtual_list_scenario>},
+    {"node_editor", run<node_editor_scenario>},
+    {"widget_grid", run<widget_grid_scenario>},
+    {"widget_grid_adaptive", run<widget_grid_adaptive_scenario>},
+    {"heavy_text", run<text_scenario>},
+};
+
+} // namespace
+
+int main(int argc, char** argv) {
+    int frame_count = default_frame_count;
+    int first_name = 1;
+    if (argc > 1 && std::atoi(argv[1]) > 0) {
+        frame_count = std::atoi(argv[1]);
+        first_name = 2;
+    }
+
+    std::printf("{\n  \"nuklear_tag\": \"be0a3f6\",\n  \"vertex_kernels\": \"%s\",\n  \"warmup_frames\": %d,\n"
+                "  \"scenarios\": [\n",
+                nk::vertex_kernel_isa(), warmup_frame_count);
+    bool first = true;
+    for (const auto& entry : scenarios) {
+        const bool selected = first_name >= argc
+            || std::any_of(argv + first_name, argv + argc,
+                           [&](const char* arg) { return std::strcmp(arg, entry.name) == 0; });
+        if (selected) {
+            entry.run(entry.name, frame_count, first);
+            first = false;
+        }
+    }
+    std::printf("\n  ]\n}\n");
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,113 @@
+// nk::trace_writerで記録したトレースを、元のアプリケーションなしで再生する
+// 各フレームのコマンドキューをconverterで変換し、ヘッドレスバックエンドで描画して時間を測る
+// テキストはヘッドレスバックエンドのデフォルトフォントで、画像は白い矩形として描く
+// 結果はJSONで標準出力に書き出す
+//
+// 使い方: nuklear_cpp_replay トレースファイル [繰り返し回数] [最後のフレームを書き出すPPM]
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+#include "nuklear-cpp.hpp"
+
+namespace {
+
+struct frame_sample {
+    std::uint64_t index;
+    std::size_t commands;
+    double convert_ns;
+    double rasterize_ns;
+};
+
+double percentile(std::vector<double> values, double p) {
+    if (values.empty()) {
+        return 0.0;
+    }
+    const auto index = static_cast<std::size_t>(p * static_cast<double>(values.size() - 1) + 0.5);
+    std::nth_element(values.begin(), values.begin() + index, values.end());
+    return values[index];
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    if (argc < 2) {
+        std::fprintf(stderr, "usage: %s trace [repeat] [last_frame.ppm]\n", argv[0]);
+        return 1;
+    }
+    const int repeat = argc > 2 && std::atoi(argv[2]) > 0 ? std::atoi(argv[2]) : 1;
+
+    nk::trace_reader reader{argv[1]};
+    if (!reader.is_open()) {
+        std::fprintf(stderr, "%s: not a trace file\n", argv[1]);
+        return 1;
+    }
+    nk::headless_context headless{std::max(reader.width(), 1), std::max(reader.height(), 1)};
+    reader.set_font(headless.font());
+
+    // 読み込みの時間を測らないよう、先に全フレームを読んでおく
+    std::vector<nk::trace_frame> frames;
+    for (nk::trace_frame frame; reader.next(frame);) {
+        frames.push_back(std::move(frame));
+    }
+
+    nk::converter converter;
+    nk::draw_data data;
+    std::vector<frame_sample> samples(frames.size());
+    using clock = std::chrono::steady_clock;
+    for (int round = 0; round < repeat; ++round) {
+        for (std::size_t i = 0; i < frames.size(); ++i) {
+            const clock::time_point begin = clock::now();
+            converter.convert(frames[i].commands, headless.options(), data);
+            const clock::time_point converted = clock::now();
+            headless.target().clear(nk_color{30, 30, 30, 255});
+            nk::rasterize(data, headless.target());
+            const clock::time_point end = clock::now();
+
+            // 繰り返した中で最も速かった値を残す
+            const double convert_ns = std::chrono::duration<double, std::nano>(converted - begin).count();
+            const double rasterize_ns = std::chrono::duration<double, std::nano>(end - converted).count();
+            frame_sample& s = samples[i];
+            if (round == 0) {
+                s = {frames[i].index, frames[i].commands.size(), convert_ns, rasterize_ns};
+            } else {
+                s.convert_ns = std::min(s.convert_ns, convert_ns);
+                s.rasterize_ns = std::min(s.rasterize_ns, rasterize_ns);
+            }
+        }
+    }
+    if (argc > 3 && !frames.empty()) {
+        headless.target().write_ppm(argv[3]);
+    }
+
+    std::vector<double> convert_ns;
+    std::vector<double> rasterize_ns;
+    const frame_sample* slowest = nullptr;
+    std::size_t command_count = 0;
+    for (const frame_sample& s : samples) {
+        convert_ns.push_back(s.convert_ns);
+        rasterize_ns.push_back(s.rasterize_ns);
+        command_count += s.commands;
+        if (slowest == nullptr || s.convert_ns + s.rasterize_ns > slowest->convert_ns + slowest->rasterize_ns) {
+            slowest = &s;
+        }
+    }
+    std::printf("{\n  \"trace\": \"%s\",\n  \"frames\": %zu,\n  \"commands\": %zu,\n  \"repeat\": %d,\n"
+                "  \"vertex_kernels\": \"%s\",\n",
+                argv[1], frames.size(), command_count, repeat, nk::vertex_kernel_isa());
+    std::printf("  \"convert\": {\"p50_ns\": %.0f, \"p99_ns\": %.0f, \"max_ns\": %.0f},\n",
+                percentile(convert_ns, 0.50), percentile(convert_ns, 0.99), percentile(convert_ns, 1.0));
+    std::printf("  \"rasterize\": {\"p50_ns\": %.0f, \"p99_ns\": %.0f, \"max_ns\": %.0f},\n",
+                percentile(rasterize_ns, 0.50), percentile(rasterize_ns, 0.99), percentile(rasterize_ns, 1.0));
+    if (slowest != nullptr) {
+        std::printf("  \"slowest_frame\": {\"index\": %llu, \"commands\": %zu, \"convert_ns\": %.0f, "
+                    "\"rasterize_ns\": %.0f}\n}\n",
+                    static_cast<unsigned long long>(slowest->index), slowest->commands, slowest->convert_ns,
+                    slowest->rasterize_ns);
+    } else {
+        std::printf("  \"slowest_frame\": null\n}\n");
+    }
+    return 0;
+}
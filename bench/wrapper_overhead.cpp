@@ -0,0 +1,171 @@
+// main_origin.cppのデモウィンドウを、生のC APIとC++ラッパーでそれぞれ構築して比較する
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+#include "nuklear-cpp.hpp"
+
+namespace {
+
+constexpr int frame_count = 100000;
+constexpr int round_count = 5;
+// ラッパーの最良値が生のC APIの最良値をこの割合より上回ったら失敗にする
+// 最良値どうしの比較でも残る計測の揺らぎを見込んだ値。第1引数(%)で変えられる
+constexpr double default_tolerance_percent = 3.0;
+constexpr nk_flags demo_flags =
+    NK_WINDOW_BORDER | NK_WINDOW_MOVABLE | NK_WINDOW_SCALABLE | NK_WINDOW_MINIMIZABLE | NK_WINDOW_TITLE;
+
+// 文字幅を固定にした計測用のフォント
+float fixed_width(nk_handle, float height, const char*, int len) {
+    return static_cast<float>(len) * height * 0.5f;
+}
+
+struct demo_state {
+    enum { EASY, HARD };
+    int op = EASY;
+    int property = 20;
+    nk_colorf bg{0.10f, 0.18f, 0.24f, 1.0f};
+    int pressed = 0;
+};
+
+void build_raw(nk_context* ctx, demo_state& s) {
+    if (nk_begin(ctx, "Demo", nk_rect(50, 50, 230, 250), demo_flags)) {
+        nk_layout_row_static(ctx, 30, 80, 1);
+        if (nk_button_label(ctx, "button"))
+            ++s.pressed;
+        nk_layout_row_dynamic(ctx, 30, 2);
+        if (nk_option_label(ctx, "easy", s.op == demo_state::EASY)) s.op = demo_state::EASY;
+        if (nk_option_label(ctx, "hard", s.op == demo_state::HARD)) s.op = demo_state::HARD;
+        nk_layout_row_dynamic(ctx, 25, 1);
+        nk_property_int(ctx, "Compression:", 0, &s.property, 100, 10, 1);
+
+        nk_layout_row_dynamic(ctx, 20, 1);
+        nk_label(ctx, "background:", NK_TEXT_LEFT);
+        nk_layout_row_dynamic(ctx, 25, 1);
+        if (nk_combo_begin_color(ctx, nk_rgb_cf(s.bg), nk_vec2(nk_widget_width(ctx), 400))) {
+            nk_layout_row_dynamic(ctx, 120, 1);
+            s.bg = nk_color_picker(ctx, s.bg, NK_RGBA);
+            nk_layout_row_dynamic(ctx, 25, 1);
+            s.bg.r = nk_propertyf(ctx, "#R:", 0, s.bg.r, 1.0f, 0.01f, 0.005f);
+            s.bg.g = nk_propertyf(ctx, "#G:", 0, s.bg.g, 1.0f, 0.01f, 0.005f);
+            s.bg.b = nk_propertyf(ctx, "#B:", 0, s.bg.b, 1.0f, 0.01f, 0.005f);
+            s.bg.a = nk_propertyf(ctx, "#A:", 0, s.bg.a, 1.0f, 0.01f, 0.005f);
+            nk_combo_end(ctx);
+        }
+    }
+    nk_end(ctx);
+}
+
+void build_wrapped(nk_context* ctx, demo_state& s) {
+    if (nk::window win{ctx, "Demo", nk_rect(50, 50, 230, 250), demo_flags}) {
+        nk::row_static(ctx, 30, 80, 1);
+        if (nk_button_label(ctx, "button"))
+            ++s.pressed;
+        nk::row_dynamic(ctx, 30, 2);
+        if (nk_option_label(ctx, "easy", s.op == demo_state::EASY)) s.op = demo_state::EASY;
+        if (nk_option_label(ctx, "hard", s.op == demo_state::HARD)) s.op = demo_state::HARD;
+        nk::row_dynamic(ctx, 25, 1);
+        nk_property_int(ctx, "Compression:", 0, &s.property, 100, 10, 1);
+
+        nk::row_dynamic(ctx, 20, 1);
+        nk_label(ctx, "background:", NK_TEXT_LEFT);
+        nk::row_dynamic(ctx, 25, 1);
+        if (auto combo = nk::combo_color(ctx, nk_rgb_cf(s.bg), nk_vec2(nk_widget_width(ctx), 400))) {
+            nk::row_dynamic(ctx, 120, 1);
+            s.bg = nk_color_picker(ctx, s.bg, NK_RGBA);
+            nk::row_dynamic(ctx, 25, 1);
+            s.bg.r = nk_propertyf(ctx, "#R:", 0, s.bg.r, 1.0f, 0.01f, 0.005f);
+            s.bg.g = nk_propertyf(ctx, "#G:", 0, s.bg.g, 1.0f, 0.01f, 0.005f);
+            s.bg.b = nk_propertyf(ctx, "#B:", 0, s.bg.b, 1.0f, 0.01f, 0.005f);
+            s.bg.a = nk_propertyf(ctx, "#A:", 0, s.bg.a, 1.0f, 0.01f, 0.005f);
+        }
+    }
+}
+
+// 1フレーム分のコマンド列を、各コマンドの使っているバイトをつないだものとして取り出す
+// 種類だけでなく矩形・色・文字列まで同じであることを比べる
+std::vector<std::byte> command_bytes(nk_context* ctx) {
+    std::vector<std::byte> bytes;
+    const nk_command* cmd = nullptr;
+    nk_foreach(cmd, ctx) {
+        const std::size_t size = nk::command_size(cmd);
+        const std::size_t offset = bytes.size();
+        bytes.resize(offset + size);
+        std::memcpy(bytes.data() + offset, cmd, size);
+    }
+    return bytes;
+}
+
+template <class Build>
+std::vector<std::byte> first_frame(nk_user_font& font, Build build) {
+    // 構造体の詰め物のバイトも比べるので、0で埋めた固定のメモリで初期化する
+    std::vector<std::byte> memory(1 << 20);
+    nk_context ctx;
+    nk_init_fixed(&ctx, memory.data(), memory.size(), &font);
+    demo_state state;
+    nk_input_begin(&ctx);
+    nk_input_end(&ctx);
+    build(&ctx, state);
+    auto bytes = command_bytes(&ctx);
+    nk_free(&ctx);
+    return bytes;
+}
+
+template <class Build>
+double run(nk_context* ctx, demo_state& state, Build build) {
+    const auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < frame_count; ++i) {
+        build(ctx, state);
+        nk_clear(ctx);
+    }
+    const auto elapsed = std::chrono::steady_clock::now() - start;
+    return std::chrono::duration<double, std::nano>(elapsed).count() / frame_count;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    const double tolerance_percent = argc > 1 ? std::atof(argv[1]) : default_tolerance_percent;
+    nk_user_font font{};
+    font.height = 13.0f;
+    font.width = fixed_width;
+
+    // 同じ入力から同じコマンド列が作られることを確認する
+    if (first_frame(font, build_raw) != first_frame(font, build_wrapped)) {
+        std::fprintf(stderr, "wrapper emitted a different command stream than the C API\n");
+        return EXIT_FAILURE;
+    }
+
+    nk_context raw_ctx;
+    nk_context wrapped_ctx;
+    nk_init_default(&raw_ctx, &font);
+    nk_init_default(&wrapped_ctx, &font);
+    demo_state raw_state;
+    demo_state wrapped_state;
+
+    // 計測順による偏りを避けるため交互に実行し、各方式の最良値を比べる
+    double raw_best = 1e300;
+    double wrapped_best = 1e300;
+    for (int round = 0; round < round_count; ++round) {
+        raw_best = std::min(raw_best, run(&raw_ctx, raw_state, build_raw));
+        wrapped_best = std::min(wrapped_best, run(&wrapped_ctx, wrapped_state, build_wrapped));
+    }
+
+    std::printf("frames per round : %d\n", frame_count);
+    std::printf("raw C API        : %.1f ns/frame\n", raw_best);
+    std::printf("nuklear-cpp      : %.1f ns/frame\n", wrapped_best);
+    const double overhead_percent = (wrapped_best / raw_best - 1.0) * 100.0;
+    std::printf("overhead         : %+.2f%% (tolerance %.2f%%)\n", overhead_percent, tolerance_percent);
+
+    nk_free(&raw_ctx);
+    nk_free(&wrapped_ctx);
+    if (overhead_percent > tolerance_percent) {
+        std::fprintf(stderr, "wrapper is slower than the C API beyond the tolerance\n");
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
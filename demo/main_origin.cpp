@@ -2,27 +2,108 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <stdint.h>
+#include <stddef.h>
 #include <stdarg.h>
 #include <string.h>
 #include <math.h>
 #include <assert.h>
 #include <limits.h>
 #include <time.h>
+#include <optional>
 
 #include <SDL2/SDL.h>
 
-#define NK_INCLUDE_FIXED_TYPES
-#define NK_INCLUDE_STANDARD_IO
-#define NK_INCLUDE_STANDARD_VARARGS
-#define NK_INCLUDE_DEFAULT_ALLOCATOR
-#define NK_INCLUDE_VERTEX_BUFFER_OUTPUT
-#define NK_INCLUDE_FONT_BAKING
-#define NK_INCLUDE_DEFAULT_FONT
-#define NK_IMPLEMENTATION
+/* Nuklear itself is configured and compiled by the Nuklear-cpp library */
+#include "nuklear-cpp.hpp"
+/* nk_sdl_vertex has the same layout as nk::vertex, so vertices are written by
+ * the library's SIMD kernels instead of the generic nk_convert path. Circles,
+ * arcs, curves and rounded corners get just enough segments to stay within a
+ * quarter pixel of the true shape, up to the fixed counts nk_sdl_render sets.
+ * The glyph quads of each label are built once and reused while it is shown;
+ * the main loop ages the cache once per frame */
+static nk::text_cache sdl_text_runs;
+#define NK_SDL_CONVERT(ctx, cmds, vbuf, ebuf, config) \
+    nk::convert(ctx, cmds, vbuf, ebuf, config, 0.25f, &sdl_text_runs)
+/* The baked font atlas is kept in the temp directory, so only the first run
+ * rasterizes the glyphs; later runs map the file and upload it directly.
+ * main creates the cache; without a usable temp directory it bakes as usual */
+static std::optional<nk::atlas_cache> sdl_atlas_cache;
+#define NK_SDL_FONT_BAKE(atlas, w, h) \
+    (sdl_atlas_cache ? sdl_atlas_cache->bake(atlas, w, h) \
+                     : nk_font_atlas_bake(atlas, w, h, NK_FONT_ATLAS_RGBA32))
+/* Clipboard and text input go through nk::text_input: copies reuse one
+ * buffer, and a large paste is fed to the edit box 64KiB per frame straight
+ * from SDL's clipboard string, so pasting a big log does not stall a frame */
+static std::string_view sdl_clipboard_get(void *)
+{
+    const char *text = SDL_GetClipboardText();
+    return text ? std::string_view(text) : std::string_view();
+}
+static void sdl_clipboard_release(void *, std::string_view text)
+{
+    SDL_free(const_cast<char*>(text.data()));
+}
+static void sdl_clipboard_set(void *, const char *text)
+{
+    SDL_SetClipboardText(text);
+}
+static nk::text_input sdl_text_input({nullptr, sdl_clipboard_get, sdl_clipboard_release, sdl_clipboard_set});
+#define NK_SDL_TEXT_INPUT(ctx, text) sdl_text_input.feed(text)
+/* Per-stage timings and the counts the backend actually issued go into
+ * nk::profiler. With NUKLEAR_CPP_ENABLE_PROFILER off every call is empty */
+static nk::profiler sdl_profiler;
+static void sdl_profile_buffers(const struct nk_buffer *cmds, const struct nk_buffer *vbuf,
+    const struct nk_buffer *ebuf)
+{
+    sdl_profiler.sample_buffer(*cmds);
+    sdl_profiler.sample_buffer(*vbuf);
+    sdl_profiler.sample_buffer(*ebuf);
+    /* nk_sdl_vertex has the same layout as nk::vertex */
+    sdl_profiler.set(nk::profile_counter::vertices, vbuf->needed / sizeof(nk::vertex));
+    sdl_profiler.set(nk::profile_counter::indices, ebuf->needed / sizeof(nk_draw_index));
+}
+#define NK_SDL_PROFILE_BEGIN(sdl, stage) sdl_profiler.start(nk::profile_stage::stage)
+#define NK_SDL_PROFILE_END(sdl, stage) sdl_profiler.stop(nk::profile_stage::stage)
+#define NK_SDL_PROFILE_BUFFERS(sdl, cmds, vbuf, ebuf) sdl_profile_buffers(cmds, vbuf, ebuf)
+#define NK_SDL_PROFILE_DRAW(sdl, draw_calls, clip_changes) \
+    sdl_profiler.sample_submit((std::uint64_t)(draw_calls), (std::uint64_t)(clip_changes))
+#include "nuklear_sdl_renderer.h"
+
+/* nk_sdl_render's vertex layout table, stride and alignment are derived from
+ * struct nk_sdl_vertex at compile time instead of being built at runtime */
+template <>
+struct nk::vertex_format<nk_sdl_vertex> {
+    static constexpr nk::vertex_attribute position{NK_FORMAT_FLOAT, offsetof(nk_sdl_vertex, position)};
+    static constexpr nk::vertex_attribute uv{NK_FORMAT_FLOAT, offsetof(nk_sdl_vertex, uv)};
+    static constexpr nk::vertex_attribute color{NK_FORMAT_R8G8B8A8, offsetof(nk_sdl_vertex, col)};
+};
+using sdl_vertex_layout = nk::vertex_layout<nk_sdl_vertex>;
+/* nk::convert only writes vertices with the SIMD kernels, without a packing
+ * pass, when the layout is the one of nk::vertex */
+static_assert(sdl_vertex_layout::matches_vertex, "nk_sdl_vertex must have the layout of nk::vertex");
+#define NK_SDL_VERTEX_LAYOUT sdl_vertex_layout::elements.data()
+#define NK_SDL_VERTEX_SIZE sdl_vertex_layout::size
+#define NK_SDL_VERTEX_ALIGNMENT sdl_vertex_layout::alignment
 #define NK_SDL_RENDERER_IMPLEMENTATION
-#include "nuklear.h"
 #include "nuklear_sdl_renderer.h"
 
+/* Frames only run after input, while a mouse button is held or when
+ * something asks for one; in between the loop sleeps in SDL_WaitEvent.
+ * nk::frame_scheduler::request_frame wakes it from any thread by pushing a
+ * user event */
+static Uint32 sdl_wake_event;
+static bool sdl_wait(void *, int timeout_ms)
+{
+    return (timeout_ms < 0 ? SDL_WaitEvent(NULL) : SDL_WaitEventTimeout(NULL, timeout_ms)) != 0;
+}
+static void sdl_wake(void *)
+{
+    SDL_Event event;
+    SDL_zero(event);
+    event.type = sdl_wake_event;
+    SDL_PushEvent(&event);
+}
+
 #define WINDOW_WIDTH 1200
 #define WINDOW_HEIGHT 800
 
@@ -39,6 +120,44 @@
 /*#define INCLUDE_OVERVIEW */
 /*#define INCLUDE_NODE_EDITOR */
 
+/* Convert the command queue on a worker thread while the next frame is being
+ * built; what is drawn then lags one frame behind the input */
+/*#define PIPELINED_CONVERT */
+
+/* Rasterize glyphs the first time they are drawn instead of baking the whole
+ * font up front, which is what fonts with thousands of CJK glyphs need. The
+ * glyph atlas is filled while converting, so it cannot be used from the
+ * pipeline's worker thread */
+/*#define GLYPH_ATLAS */
+/* Record every frame's input and command queue; replay the file with
+ * nuklear_cpp_replay to profile convert/render without this program */
+/*#define RECORD_TRACE "demo.nktrace" */
+/* Show a toolbar of generated icons packed into the backend's image atlas,
+ * which draws all of them with one draw call */
+/*#define IMAGE_ATLAS */
+/* Write the profiler's last frames to a CSV file on exit; needs the library
+ * built with NUKLEAR_CPP_ENABLE_PROFILER */
+/*#define DUMP_PROFILE */
+
+#if defined(GLYPH_ATLAS) && defined(PIPELINED_CONVERT)
+  #error "GLYPH_ATLAS cannot be combined with PIPELINED_CONVERT"
+#endif
+
+#ifdef GLYPH_ATLAS
+static nk::glyph_atlas sdl_glyphs;
+
+/* uploads what the conversion just rasterized */
+static void
+upload_glyphs(struct nk_sdl *sdl, void *userdata)
+{
+    nk::glyph_atlas *glyphs = (nk::glyph_atlas*)userdata;
+    const struct nk_recti dirty = glyphs->dirty_rect();
+    if (dirty.w <= 0) return;
+    nk_sdl_font_update(sdl, glyphs->dirty_pixels(), glyphs->pitch(), dirty.x, dirty.y, dirty.w, dirty.h);
+    glyphs->clear_dirty();
+}
+#endif
+
 #ifdef INCLUDE_ALL
   #define INCLUDE_STYLE
   #define INCLUDE_CALCULATOR
@@ -63,6 +182,27 @@
   #include "../../demo/common/node_editor.c"
 #endif
 
+#ifdef IMAGE_ATLAS
+#define ICON_COUNT 48
+#define ICON_SIZE 24
+/* a disc with its own hue per icon, as RGBA32 */
+static void make_icon(int index, nk_byte *pixels)
+{
+    struct nk_color color = nk_hsv_f((float)index / ICON_COUNT, 0.7f, 0.9f);
+    float r = ICON_SIZE * 0.5f;
+    int x, y;
+    for (y = 0; y < ICON_SIZE; ++y) {
+        for (x = 0; x < ICON_SIZE; ++x) {
+            float dx = (float)x + 0.5f - r, dy = (float)y + 0.5f - r;
+            float alpha = NK_CLAMP(0.0f, r - sqrtf(dx * dx + dy * dy), 1.0f);
+            nk_byte *p = pixels + (y * ICON_SIZE + x) * 4;
+            p[0] = color.r; p[1] = color.g; p[2] = color.b;
+            p[3] = (nk_byte)(alpha * 255.0f);
+        }
+    }
+}
+#endif
+
 /* ===============================================================
  *
  *                          DEMO
@@ -77,12 +217,25 @@ int main(int argc, char* args[]) {
     float font_scale = 1;
 
     /* GUI */
+    struct nk_sdl sdl;
     struct nk_context *ctx;
     struct nk_colorf bg;
+    std::optional<nk::convert_pipeline> pipeline;
+    #ifdef RECORD_TRACE
+    nk::trace_writer trace(RECORD_TRACE, WINDOW_WIDTH, WINDOW_HEIGHT);
+    #endif
+    nk::draw_data frame;
+    nk::frame_scheduler scheduler({nullptr, sdl_wait, sdl_wake});
+    #ifdef IMAGE_ATLAS
+    struct nk_sdl_images images;
+    int icons[ICON_COUNT];
+    nk_byte icon_pixels[ICON_SIZE * ICON_SIZE * 4];
+    #endif
 
     /* SDL setup */
     SDL_SetHint(SDL_HINT_VIDEO_HIGHDPI_DISABLED, "0");
     SDL_Init(SDL_INIT_VIDEO);
+    sdl_wake_event = SDL_RegisterEvents(1);
 
     win = SDL_CreateWindow("Demo",
         SDL_WINDOWPOS_CENTERED, SDL_WINDOWPOS_CENTERED,
@@ -125,17 +278,41 @@ int main(int argc, char* args[]) {
     }
 
     /* GUI */
-    ctx = nk_sdl_init(win, renderer);
+    ctx = nk_sdl_init(&sdl, win, renderer);
+    sdl_text_input.install(ctx);
+    #ifdef IMAGE_ATLAS
+    nk_sdl_images_init(&images, renderer, NULL);
+    for (int n = 0; n < ICON_COUNT; ++n) {
+        make_icon(n, icon_pixels);
+        icons[n] = nk_sdl_image_add(&images, icon_pixels, ICON_SIZE * 4, ICON_SIZE, ICON_SIZE);
+    }
+    #endif
     /* Load Fonts: if none of these are loaded a default font will be used  */
     /* Load Cursor: if you uncomment cursor loading please hide the cursor */
+    #ifdef GLYPH_ATLAS
+    {
+        struct nk_user_font *font;
+        sdl_glyphs.set_texture(nk_sdl_font_dynamic(&sdl, sdl_glyphs.width(), sdl_glyphs.height(),
+            sdl_glyphs.white_uv(), upload_glyphs, &sdl_glyphs));
+        font = sdl_glyphs.add_default_font(13 * font_scale);
+        /*font = sdl_glyphs.add_font(ttf_data, ttf_size, 13 * font_scale);*/
+        font->height /= font_scale;
+        nk_style_set_font(ctx, font);
+    }
+    #else
     {
         struct nk_font_atlas *atlas;
         struct nk_font_config config = nk_font_config(0);
         struct nk_font *font;
 
+        std::error_code temp_error;
+        const std::filesystem::path temp = std::filesystem::temp_directory_path(temp_error);
+        if (!temp_error)
+            sdl_atlas_cache.emplace(temp / "nuklear-cpp-atlas");
+
         /* set up the font atlas and add desired font; note that font sizes are
          * multiplied by font_scale to produce better results at higher DPIs */
-        nk_sdl_font_stash_begin(&atlas);
+        nk_sdl_font_stash_begin(&sdl, &atlas);
         font = nk_font_atlas_add_default(atlas, 13 * font_scale, &config);
         /*font = nk_font_atlas_add_from_file(atlas, "../../../extra_font/DroidSans.ttf", 14 * font_scale, &config);*/
         /*font = nk_font_atlas_add_from_file(atlas, "../../../extra_font/Roboto-Regular.ttf", 16 * font_scale, &config);*/
@@ -143,7 +320,7 @@ int main(int argc, char* args[]) {
         /*font = nk_font_atlas_add_from_file(atlas, "../../../extra_font/ProggyClean.ttf", 12 * font_scale, &config);*/
         /*font = nk_font_atlas_add_from_file(atlas, "../../../extra_font/ProggyTiny.ttf", 10 * font_scale, &config);*/
         /*font = nk_font_atlas_add_from_file(atlas, "../../../extra_font/Cousine-Regular.ttf", 13 * font_scale, &config);*/
-        nk_sdl_font_stash_end();
+        nk_sdl_font_stash_end(&sdl);
 
         /* this hack makes the font appear to be scaled down to the desired
          * size and is only necessary when font_scale > 1 */
@@ -151,6 +328,13 @@ int main(int argc, char* args[]) {
         /*nk_style_load_all_cursors(ctx, atlas->cursors);*/
         nk_style_set_font(ctx, &font->handle);
     }
+    #endif
+
+    /* text widths are measured once per string and size, and strings not shown
+     * for a while are dropped by next_frame in the main loop */
+    std::optional<nk::cached_font> measured_font;
+    measured_font.emplace(*ctx->style.font);
+    nk_style_set_font(ctx, measured_font->font());
 
     #ifdef INCLUDE_STYLE
     /* ease regression testing during Nuklear release process; not needed for anything else */
@@ -165,19 +349,58 @@ int main(int argc, char* args[]) {
     #endif
     #endif
 
+    #ifdef PIPELINED_CONVERT
+    {
+        nk::convert_options options;
+        options.tex_null = sdl.font->tex_null;
+        pipeline.emplace(options);
+        /* what a frame shows is drawn depth - 1 frames later */
+        scheduler.set_settle_frames(2 + (int)pipeline->depth() - 1);
+    }
+    #endif
+
+    /* the color tables are built at compile time; each is turned into a full
+     * nk_style once here, so switching a window's theme is a style copy */
+    const nk::theme demo_themes[] = {{ctx, nk::themes::dark}, {ctx, nk::themes::light}};
+    int demo_theme = 0;
+
     bg.r = 0.10f, bg.g = 0.18f, bg.b = 0.24f, bg.a = 1.0f;
     while (running)
     {
         /* Input */
-        SDL_Event evt;
+        SDL_Event events[128];
+        int event_count, i;
+        scheduler.wait();
+        sdl_profiler.begin_frame();
+        sdl_text_runs.next_frame();
+        measured_font->next_frame();
+        #ifdef GLYPH_ATLAS
+        /* glyphs that did not fit last frame replaced older ones, which
+         * cached text runs and the last drawn frame may still point at */
+        if (sdl_glyphs.next_frame()) {
+            sdl_text_runs.clear();
+            nk_sdl_invalidate(&sdl);
+        }
+        #endif
+        sdl_profiler.start(nk::profile_stage::input);
         nk_input_begin(ctx);
-        while (SDL_PollEvent(&evt)) {
-            if (evt.type == SDL_QUIT) goto cleanup;
-            nk_sdl_handle_event(&evt);
+        /* drain the queue and hand it over in batches, so a fast mouse costs
+         * one motion update per batch instead of one per event */
+        SDL_PumpEvents();
+        while ((event_count = SDL_PeepEvents(events, (int)(sizeof(events) / sizeof(events[0])),
+                    SDL_GETEVENT, SDL_FIRSTEVENT, SDL_LASTEVENT)) > 0) {
+            for (i = 0; i < event_count; ++i)
+                if (events[i].type == SDL_QUIT) goto cleanup;
+            nk_sdl_handle_events(&sdl, events, event_count);
         }
+        sdl_text_input.update(ctx);
         nk_input_end(ctx);
+        sdl_profiler.stop(nk::profile_stage::input);
 
         /* GUI */
+        sdl_profiler.start(nk::profile_stage::build);
+        std::optional<nk::theme_scope> themed;
+        if (demo_theme > 0) themed.emplace(ctx, demo_themes[demo_theme - 1]);
         if (nk_begin(ctx, "Demo", nk_rect(50, 50, 230, 250),
             NK_WINDOW_BORDER|NK_WINDOW_MOVABLE|NK_WINDOW_SCALABLE|
             NK_WINDOW_MINIMIZABLE|NK_WINDOW_TITLE))
@@ -192,6 +415,10 @@ int main(int argc, char* args[]) {
             nk_layout_row_dynamic(ctx, 30, 2);
             if (nk_option_label(ctx, "easy", op == EASY)) op = EASY;
             if (nk_option_label(ctx, "hard", op == HARD)) op = HARD;
+            nk_layout_row_dynamic(ctx, 25, 3);
+            if (nk_option_label(ctx, "default", demo_theme == 0)) demo_theme = 0;
+            if (nk_option_label(ctx, "dark", demo_theme == 1)) demo_theme = 1;
+            if (nk_option_label(ctx, "light", demo_theme == 2)) demo_theme = 2;
             nk_layout_row_dynamic(ctx, 25, 1);
             nk_property_int(ctx, "Compression:", 0, &property, 100, 10, 1);
 
@@ -210,6 +437,28 @@ int main(int argc, char* args[]) {
             }
         }
         nk_end(ctx);
+        /* the theme only applies to the Demo window */
+        themed.reset();
+
+        #ifdef IMAGE_ATLAS
+        if (nk_begin(ctx, "Icons", nk_rect(300, 50, 380, 160),
+            NK_WINDOW_BORDER|NK_WINDOW_MOVABLE|NK_WINDOW_SCALABLE|NK_WINDOW_TITLE))
+        {
+            nk_layout_row_static(ctx, ICON_SIZE + 8, ICON_SIZE + 8, 10);
+            for (i = 0; i < ICON_COUNT; ++i) {
+                struct nk_image icon;
+                /* evicted icons are added again */
+                if (!nk_sdl_image_get(&images, icons[i], &icon)) {
+                    make_icon(i, icon_pixels);
+                    icons[i] = nk_sdl_image_add(&images, icon_pixels, ICON_SIZE * 4, ICON_SIZE, ICON_SIZE);
+                    if (!nk_sdl_image_get(&images, icons[i], &icon)) continue;
+                }
+                if (nk_button_image(ctx, icon))
+                    fprintf(stdout, "icon %d pressed\n", i);
+            }
+        }
+        nk_end(ctx);
+        #endif
 
         /* -------------- EXAMPLES ---------------- */
         #ifdef INCLUDE_CALCULATOR
@@ -226,16 +475,59 @@ int main(int argc, char* args[]) {
         #endif
         /* ----------------------------------------- */
 
+        sdl_profiler.stop(nk::profile_stage::build);
+        sdl_profiler.sample_context(ctx);
+
+        scheduler.frame_done(ctx);
+        /* the rest of a large paste or of typed text goes in next frame */
+        if (sdl_text_input.pending())
+            scheduler.request_frame();
+
+        #ifdef RECORD_TRACE
+        trace.write_frame(ctx);
+        #endif
+
+        #ifdef IMAGE_ATLAS
+        nk_sdl_images_upload(&images);
+        #endif
+
+        #ifdef PIPELINED_CONVERT
+        pipeline->push(ctx);
+        if (pipeline->in_flight() == pipeline->depth() && pipeline->pop(frame)) {
+            sdl_profiler.sample_draw_data(frame);
+            SDL_SetRenderDrawColor(renderer, bg.r * 255, bg.g * 255, bg.b * 255, bg.a * 255);
+            SDL_RenderClear(renderer);
+            nk_sdl_render_draw_data(&sdl, frame.vertices.data(), (int)frame.vertices.size(),
+                frame.indices.data(), (int)frame.indices.size(),
+                frame.commands.data(), (int)frame.commands.size());
+            SDL_RenderPresent(renderer);
+        }
+        #else
         SDL_SetRenderDrawColor(renderer, bg.r * 255, bg.g * 255, bg.b * 255, bg.a * 255);
         SDL_RenderClear(renderer);
 
-        nk_sdl_render(NK_ANTI_ALIASING_ON);
-
-        SDL_RenderPresent(renderer);
+        if (nk_sdl_render(&sdl, NK_ANTI_ALIASING_ON))
+            SDL_RenderPresent(renderer);
+        #endif
+        #ifdef GLYPH_ATLAS
+        /* glyphs left blank for lack of room are drawn again once next_frame
+         * has evicted a shelf, even if no input arrives */
+        if (sdl_glyphs.missed())
+            scheduler.request_frame();
+        #endif
+        sdl_profiler.end_frame();
     }
 
 cleanup:
-    nk_sdl_shutdown();
+    #ifdef DUMP_PROFILE
+    sdl_profiler.dump("nuklear-cpp-profile.csv");
+    #endif
+    /* the worker may still be converting text that uses the font atlas */
+    pipeline.reset();
+    #ifdef IMAGE_ATLAS
+    nk_sdl_images_free(&images);
+    #endif
+    nk_sdl_shutdown(&sdl);
     SDL_DestroyRenderer(renderer);
     SDL_DestroyWindow(win);
     SDL_Quit();
@@ -12,12 +12,279 @@
 #define NK_SDL_RENDERER_H_
 
 #include <SDL2/SDL.h>
-NK_API struct nk_context*   nk_sdl_init(SDL_Window *win, SDL_Renderer *renderer);
-NK_API void                 nk_sdl_font_stash_begin(struct nk_font_atlas **atlas);
-NK_API void                 nk_sdl_font_stash_end(void);
-NK_API int                  nk_sdl_handle_event(SDL_Event *evt);
-NK_API void                 nk_sdl_render(enum nk_anti_aliasing);
-NK_API void                 nk_sdl_shutdown(void);
+
+#ifndef NK_SDL_MAX_TRACKED_WINDOWS
+#define NK_SDL_MAX_TRACKED_WINDOWS 64
+#endif
+#ifndef NK_SDL_MAX_DAMAGE_RECTS
+#define NK_SDL_MAX_DAMAGE_RECTS 8
+#endif
+#ifndef NK_SDL_IMAGE_PAGE_SIZE
+#define NK_SDL_IMAGE_PAGE_SIZE 1024
+#endif
+#ifndef NK_SDL_IMAGE_MAX_PAGES
+#define NK_SDL_IMAGE_MAX_PAGES 4
+#endif
+#ifndef NK_SDL_IMAGE_MAX_SHELVES
+#define NK_SDL_IMAGE_MAX_SHELVES 128
+#endif
+/* nk_sdl_render converts the command queue through NK_SDL_CONVERT, which
+ * takes the same arguments as nk_convert. Define it before including this
+ * header to use a converter specialized for struct nk_sdl_vertex. */
+#ifndef NK_SDL_CONVERT
+#define NK_SDL_CONVERT nk_convert
+#endif
+/* nk_sdl_font_stash_end bakes the atlas through NK_SDL_FONT_BAKE(atlas, w, h),
+ * which returns an RGBA32 image like nk_font_atlas_bake. Define it before
+ * including this header to load a previously baked atlas instead. */
+#ifndef NK_SDL_FONT_BAKE
+#define NK_SDL_FONT_BAKE(atlas, w, h) nk_font_atlas_bake(atlas, w, h, NK_FONT_ATLAS_RGBA32)
+#endif
+/* SDL_TEXTINPUT events are handed to NK_SDL_TEXT_INPUT(ctx, text), where text
+ * is the NUL-terminated UTF-8 string of the event. Define it before including
+ * this header to queue text that does not fit into one frame's input. */
+#ifndef NK_SDL_TEXT_INPUT
+#define NK_SDL_TEXT_INPUT(ctx, text) nk_sdl_handle_text(ctx, text)
+#endif
+/* Profiling hooks, empty by default. NK_SDL_PROFILE_BEGIN/END(sdl, stage)
+ * bracket the conversion (stage is the token convert) and the draw loop
+ * (submit). NK_SDL_PROFILE_BUFFERS(sdl, cmds, vbuf, ebuf) runs after a
+ * conversion and NK_SDL_PROFILE_DRAW(sdl, draw_calls, clip_changes) after
+ * drawing, with the counts the backend actually issued. */
+#ifndef NK_SDL_PROFILE_BEGIN
+#define NK_SDL_PROFILE_BEGIN(sdl, stage) ((void)0)
+#endif
+#ifndef NK_SDL_PROFILE_END
+#define NK_SDL_PROFILE_END(sdl, stage) ((void)0)
+#endif
+#ifndef NK_SDL_PROFILE_BUFFERS
+#define NK_SDL_PROFILE_BUFFERS(sdl, cmds, vbuf, ebuf) ((void)0)
+#endif
+#ifndef NK_SDL_PROFILE_DRAW
+#define NK_SDL_PROFILE_DRAW(sdl, draw_calls, clip_changes) ((void)0)
+#endif
+
+/* Vertex/element storage used by nk_sdl_render is kept alive between frames.
+ * Capacity only grows (to the largest frame seen so far, rounded up by the
+ * nk_buffer grow factor), so steady-state frames do no heap allocation. */
+struct nk_sdl_buffer_stats {
+    nk_size vertex_high_water;  /* largest converted vertex payload in bytes */
+    nk_size element_high_water; /* largest converted element payload in bytes */
+    nk_size vertex_capacity;    /* bytes currently reserved for vertices */
+    nk_size element_capacity;   /* bytes currently reserved for elements */
+};
+
+/* Frame diffing hashes the command queue before converting it. When the hash
+ * matches the previous frame, REUSE draws last frame's vertices again without
+ * calling nk_convert, and SKIP draws nothing at all; nk_sdl_render then
+ * returns nk_false so the caller can leave SDL_RenderPresent out and keep the
+ * previously presented frame on screen. */
+enum nk_sdl_frame_diff {
+    NK_SDL_FRAME_DIFF_OFF,
+    NK_SDL_FRAME_DIFF_REUSE,
+    NK_SDL_FRAME_DIFF_SKIP
+};
+
+/* Draw commands are batched before submission: consecutive commands with the
+ * same texture and either the same clip rect or geometry that needs no
+ * clipping become one SDL_RenderGeometryRaw call over a tight vertex range.
+ * The stats describe the last nk_sdl_render call. */
+struct nk_sdl_render_stats {
+    int commands;     /* non-empty draw commands produced by nk_convert */
+    int draw_calls;   /* SDL_RenderGeometryRaw calls issued */
+    int clip_changes; /* SDL_RenderSetClipRect calls issued */
+};
+
+struct nk_sdl_window_state {
+    nk_hash name;
+    Uint64 hash;
+    struct nk_rect bounds;
+};
+
+/* Image atlas: small user images (icons, thumbnails) are packed into shared
+ * NK_SDL_IMAGE_PAGE_SIZE square RGBA32 pages, so images on the same page draw
+ * as one batch. Images are copied into a CPU-side copy of their page and
+ * nk_sdl_images_upload sends each page's changed region with a single
+ * SDL_UpdateTexture once per frame. Pages are packed in rows (shelves); when
+ * no row has room, the least recently used row that was not drawn in the
+ * current or previous frame is emptied and its images are evicted. */
+struct nk_sdl_image_shelf {
+    int y, height, x;
+    Uint64 last_used;
+};
+
+struct nk_sdl_image_page {
+    SDL_Texture *texture;
+    Uint32 *pixels;
+    struct nk_sdl_image_shelf shelves[NK_SDL_IMAGE_MAX_SHELVES];
+    int shelf_count;
+    SDL_Rect dirty; /* w == 0 when nothing changed since the last upload */
+};
+
+struct nk_sdl_image_entry {
+    int page, shelf; /* page < 0 for a free or evicted entry */
+    int x, y, w, h;
+    Uint16 generation;
+};
+
+struct nk_sdl_images {
+    struct nk_allocator alloc;
+    SDL_Renderer *renderer;
+    struct nk_sdl_image_page pages[NK_SDL_IMAGE_MAX_PAGES];
+    int page_count;
+    struct nk_sdl_image_entry *entries;
+    int entry_count, entry_capacity;
+    Uint64 frame;
+    /* running totals */
+    int uploads;   /* SDL_UpdateTexture calls */
+    int evictions; /* rows emptied to make room */
+};
+
+struct nk_sdl;
+
+/* The font atlas and its texture. It is reference counted so contexts drawing
+ * with the same renderer can share one atlas and one texture; it is released
+ * together with the last context using it. */
+struct nk_sdl_font {
+    struct nk_font_atlas atlas;
+    struct nk_allocator alloc;
+    SDL_Renderer *renderer;
+    SDL_Texture *texture;
+    struct nk_draw_null_texture tex_null;
+    int refs;
+    /* set for textures filled by the app (see nk_sdl_font_dynamic) */
+    void (*update)(struct nk_sdl *sdl, void *userdata);
+    void *update_userdata;
+};
+
+/* What nk_sdl_render converts the command queue into */
+struct nk_sdl_vertex {
+    float position[2];
+    float uv[2];
+    nk_byte col[4];
+};
+
+struct nk_sdl_device {
+    /* filled once by nk_sdl_init; only anti-aliasing and the font's white
+     * texel change after that */
+    struct nk_convert_config config;
+    struct nk_buffer cmds;
+    struct nk_buffer vbuf;
+    struct nk_buffer ebuf;
+    struct nk_buffer batches;
+    int batch_count;
+    struct nk_sdl_render_stats stats;
+    nk_size vbuf_high_water;
+    nk_size ebuf_high_water;
+    Uint64 frame_hash;
+    nk_bool frame_valid;
+    SDL_Texture *target;
+    int target_w, target_h;
+    SDL_Rect target_bounds;
+    struct nk_sdl_window_state windows[NK_SDL_MAX_TRACKED_WINDOWS];
+    int window_count;
+    SDL_Rect damage[NK_SDL_MAX_DAMAGE_RECTS];
+    int damage_count;
+    nk_bool damage_full;
+    struct nk_color clear_color;
+};
+
+/* All backend state for one window lives in a caller-owned struct nk_sdl, so
+ * any number of windows/contexts can be driven from one process. Each owns
+ * its context, command/convert buffers and render target. */
+struct nk_sdl {
+    SDL_Window *win;
+    Uint32 window_id;
+    SDL_Renderer *renderer;
+    struct nk_sdl_device ogl;
+    struct nk_context ctx;
+    struct nk_sdl_font *font;
+    struct nk_allocator alloc;
+    enum nk_sdl_frame_diff frame_diff;
+    nk_bool damage_tracking;
+};
+
+NK_API struct nk_context*   nk_sdl_init(struct nk_sdl *sdl, SDL_Window *win, SDL_Renderer *renderer);
+/* same as nk_sdl_init but backs the context, command/convert buffers and the
+ * font atlas with `alloc` (copied; NULL selects the default allocator) */
+NK_API struct nk_context*   nk_sdl_init_allocator(struct nk_sdl *sdl, SDL_Window *win, SDL_Renderer *renderer, const struct nk_allocator *alloc);
+NK_API void                 nk_sdl_font_stash_begin(struct nk_sdl *sdl, struct nk_font_atlas **atlas);
+NK_API void                 nk_sdl_font_stash_end(struct nk_sdl *sdl);
+/* makes `sdl` use the font atlas and texture of `source` instead of its own,
+ * which only works for contexts drawing with the same renderer; returns
+ * nk_false and leaves `sdl` unchanged otherwise */
+NK_API nk_bool              nk_sdl_share_font(struct nk_sdl *sdl, struct nk_sdl *source);
+/* replaces the baked atlas with an empty width x height texture filled by the
+ * app, e.g. a glyph atlas rasterized on demand. `white_uv` must be a fully
+ * white texel; `update` (may be NULL) runs after every conversion so glyphs
+ * added while converting can be uploaded with nk_sdl_font_update before the
+ * frame is drawn. Returns the texture handle fonts must draw with, or a NULL
+ * handle on failure */
+NK_API nk_handle            nk_sdl_font_dynamic(struct nk_sdl *sdl, int width, int height, struct nk_vec2 white_uv,
+                                void (*update)(struct nk_sdl *sdl, void *userdata), void *userdata);
+/* copies a w x h block of RGBA32 pixels, `pitch` bytes per row, to (x, y) of
+ * the font texture */
+NK_API void                 nk_sdl_font_update(struct nk_sdl *sdl, const void *pixels, int pitch, int x, int y, int w, int h);
+/* events of other windows are ignored and 0 is returned */
+NK_API int                  nk_sdl_handle_event(struct nk_sdl *sdl, SDL_Event *evt);
+/* feeds every event drained this frame at once, between nk_input_begin and
+ * nk_input_end. Mouse motion collapses into the final position and wheel
+ * deltas are summed, so Nuklear is fed once per frame however fast the mouse
+ * polls; the keyboard state and mouse grab are looked at once. Returns the
+ * number of events used; events of other windows are skipped */
+NK_API int                  nk_sdl_handle_events(struct nk_sdl *sdl, const SDL_Event *events, int count);
+NK_API nk_bool              nk_sdl_render(struct nk_sdl *sdl, enum nk_anti_aliasing);
+NK_API void                 nk_sdl_shutdown(struct nk_sdl *sdl);
+
+NK_API void                 nk_sdl_reserve_draw_buffers(struct nk_sdl *sdl, nk_size vertex_bytes, nk_size element_bytes);
+NK_API void                 nk_sdl_draw_buffer_stats(const struct nk_sdl *sdl, struct nk_sdl_buffer_stats *stats);
+
+NK_API void                 nk_sdl_set_frame_diff(struct nk_sdl *sdl, enum nk_sdl_frame_diff mode);
+/* forces the next frame to be converted and drawn (e.g. after the app drew
+ * something of its own); window events already do this */
+NK_API void                 nk_sdl_invalidate(struct nk_sdl *sdl);
+
+/* Damage tracking renders into a persistent target texture and, each frame,
+ * only clears and redraws the regions of windows whose command sub-stream,
+ * bounds or stacking changed since the last frame. The target is then copied
+ * over the whole render target, so the app's own SDL_RenderClear is covered
+ * and the background comes from nk_sdl_set_clear_color. nk_sdl_render returns
+ * nk_false when nothing was damaged. Damage is collected from the per-window
+ * command buffers, so it falls back to full redraws if nk__begin/nk_foreach
+ * ran before nk_sdl_render in the same frame. */
+NK_API void                 nk_sdl_set_damage_tracking(struct nk_sdl *sdl, nk_bool enable);
+NK_API void                 nk_sdl_set_clear_color(struct nk_sdl *sdl, struct nk_color color);
+/* copies up to `max` rects redrawn by the last nk_sdl_render and returns how
+ * many there were */
+NK_API int                  nk_sdl_damage_rects(const struct nk_sdl *sdl, SDL_Rect *rects, int max);
+
+NK_API void                 nk_sdl_render_stats(const struct nk_sdl *sdl, struct nk_sdl_render_stats *stats);
+
+/* Draws geometry converted elsewhere, e.g. by a worker thread from a copy of
+ * the command queue, with the same batching as nk_sdl_render. `vertices` use
+ * the layout float position[2], float uv[2], nk_byte col[4]. The context's
+ * command queue is left alone, frame diffing and damage tracking do not
+ * apply, and the next nk_sdl_render converts and redraws everything. */
+NK_API void                 nk_sdl_render_draw_data(struct nk_sdl *sdl, const void *vertices, int vertex_count,
+                                                    const nk_draw_index *indices, int index_count,
+                                                    const struct nk_draw_command *commands, int command_count);
+
+/* `alloc` backs the entry table and the CPU copies of the pages (copied; NULL
+ * selects the default allocator). Pages are created on first use. */
+NK_API void                 nk_sdl_images_init(struct nk_sdl_images *images, SDL_Renderer *renderer, const struct nk_allocator *alloc);
+NK_API void                 nk_sdl_images_free(struct nk_sdl_images *images);
+/* copies a w x h RGBA32 image, `pitch` bytes per row, into a page and returns
+ * its id, or -1 when it is larger than a page or no room could be made; such
+ * images need a texture of their own */
+NK_API int                  nk_sdl_image_add(struct nk_sdl_images *images, const void *pixels, int pitch, int w, int h);
+/* gives the sub-image of `id` to draw this frame and marks it as used. Ask
+ * again every frame: returns nk_false once the image has been evicted or
+ * removed, and it has to be added again */
+NK_API nk_bool              nk_sdl_image_get(struct nk_sdl_images *images, int id, struct nk_image *image);
+NK_API void                 nk_sdl_image_remove(struct nk_sdl_images *images, int id);
+/* uploads what was added since the last call, one update per changed page,
+ * and starts the next frame; call once per frame before nk_sdl_render */
+NK_API void                 nk_sdl_images_upload(struct nk_sdl_images *images);
 
 #if SDL_COMPILEDVERSION < SDL_VERSIONNUM(2, 0, 22)
 /* Metal API does not support cliprects with negative coordinates or large
@@ -40,162 +307,692 @@ NK_API void                 nk_sdl_shutdown(void);
  */
 #ifdef NK_SDL_RENDERER_IMPLEMENTATION
 
+#include <string.h>
 #include <strings.h>
 
-struct nk_sdl_device {
-    struct nk_buffer cmds;
-    struct nk_draw_null_texture tex_null;
-    SDL_Texture *font_tex;
+struct nk_sdl_batch {
+    SDL_Texture *texture;
+    SDL_Rect clip;
+    nk_bool contained; /* geometry lies inside clip, so clip may grow */
+    unsigned int index_offset;
+    unsigned int index_count;
+    unsigned int vertex_first;
+    unsigned int vertex_last;
 };
 
-struct nk_sdl_vertex {
-    float position[2];
-    float uv[2];
-    nk_byte col[4];
+/* The vertex layout handed to NK_SDL_CONVERT. Define NK_SDL_VERTEX_LAYOUT,
+ * NK_SDL_VERTEX_SIZE and NK_SDL_VERTEX_ALIGNMENT before including the
+ * implementation to supply a table and constants computed at compile time
+ * instead of this one. */
+#ifndef NK_SDL_VERTEX_LAYOUT
+static const struct nk_draw_vertex_layout_element nk_sdl_vertex_layout[] = {
+    {NK_VERTEX_POSITION, NK_FORMAT_FLOAT, NK_OFFSETOF(struct nk_sdl_vertex, position)},
+    {NK_VERTEX_TEXCOORD, NK_FORMAT_FLOAT, NK_OFFSETOF(struct nk_sdl_vertex, uv)},
+    {NK_VERTEX_COLOR, NK_FORMAT_R8G8B8A8, NK_OFFSETOF(struct nk_sdl_vertex, col)},
+    {NK_VERTEX_LAYOUT_END}
 };
+#define NK_SDL_VERTEX_LAYOUT nk_sdl_vertex_layout
+#endif
+#ifndef NK_SDL_VERTEX_SIZE
+#define NK_SDL_VERTEX_SIZE sizeof(struct nk_sdl_vertex)
+#endif
+#ifndef NK_SDL_VERTEX_ALIGNMENT
+#define NK_SDL_VERTEX_ALIGNMENT NK_ALIGNOF(struct nk_sdl_vertex)
+#endif
 
-static struct nk_sdl {
-    SDL_Window *win;
-    SDL_Renderer *renderer;
-    struct nk_sdl_device ogl;
-    struct nk_context ctx;
-    struct nk_font_atlas atlas;
-} sdl;
+NK_INTERN SDL_Texture*
+nk_sdl_device_upload_atlas(SDL_Renderer *renderer, const void *image, int width, int height)
+{
+    SDL_Texture *g_SDLFontTexture = SDL_CreateTexture(renderer, SDL_PIXELFORMAT_ARGB8888, SDL_TEXTUREACCESS_STATIC, width, height);
+    if (g_SDLFontTexture == NULL) {
+        SDL_Log("error creating texture");
+        return NULL;
+    }
+    SDL_UpdateTexture(g_SDLFontTexture, NULL, image, 4 * width);
+    SDL_SetTextureBlendMode(g_SDLFontTexture, SDL_BLENDMODE_BLEND);
+    return g_SDLFontTexture;
+}
 
+NK_INTERN void
+nk_sdl_font_release(struct nk_sdl_font *font)
+{
+    struct nk_allocator alloc;
+    if (!font || --font->refs > 0) return;
+    nk_font_atlas_clear(&font->atlas);
+    if (font->texture) SDL_DestroyTexture(font->texture);
+    alloc = font->alloc;
+    alloc.free(alloc.userdata, font);
+}
 
+NK_INTERN void
+nk_sdl_buffer_reserve(struct nk_buffer *buffer, nk_size size)
+{
+    struct nk_allocator alloc;
+    if (buffer->memory.size >= size) return;
+    /* contents are transient (cleared every frame), so reallocating from
+     * scratch is cheaper than letting nk_buffer copy them on growth */
+    alloc = buffer->pool;
+    nk_buffer_free(buffer);
+    nk_buffer_init(buffer, &alloc, size);
+}
+
+NK_API void
+nk_sdl_reserve_draw_buffers(struct nk_sdl *sdl, nk_size vertex_bytes, nk_size element_bytes)
+{
+    struct nk_sdl_device *dev = &sdl->ogl;
+    nk_sdl_buffer_reserve(&dev->vbuf, vertex_bytes);
+    nk_sdl_buffer_reserve(&dev->ebuf, element_bytes);
+}
+
+NK_API void
+nk_sdl_draw_buffer_stats(const struct nk_sdl *sdl, struct nk_sdl_buffer_stats *stats)
+{
+    const struct nk_sdl_device *dev = &sdl->ogl;
+    if (!stats) return;
+    stats->vertex_high_water = dev->vbuf_high_water;
+    stats->element_high_water = dev->ebuf_high_water;
+    stats->vertex_capacity = dev->vbuf.memory.size;
+    stats->element_capacity = dev->ebuf.memory.size;
+}
+
+NK_API void
+nk_sdl_set_frame_diff(struct nk_sdl *sdl, enum nk_sdl_frame_diff mode)
+{
+    sdl->frame_diff = mode;
+    sdl->ogl.frame_valid = nk_false;
+}
+
+NK_API void
+nk_sdl_invalidate(struct nk_sdl *sdl)
+{
+    sdl->ogl.frame_valid = nk_false;
+    sdl->ogl.damage_full = nk_true;
+}
+
+NK_API void
+nk_sdl_set_damage_tracking(struct nk_sdl *sdl, nk_bool enable)
+{
+    struct nk_sdl_device *dev = &sdl->ogl;
+    sdl->damage_tracking = enable;
+    dev->damage_full = nk_true;
+    dev->window_count = 0;
+    if (!enable && dev->target) {
+        SDL_DestroyTexture(dev->target);
+        dev->target = NULL;
+    }
+}
+
+NK_API void
+nk_sdl_set_clear_color(struct nk_sdl *sdl, struct nk_color color)
+{
+    struct nk_sdl_device *dev = &sdl->ogl;
+    if (dev->clear_color.r != color.r || dev->clear_color.g != color.g ||
+        dev->clear_color.b != color.b || dev->clear_color.a != color.a)
+        dev->damage_full = nk_true;
+    dev->clear_color = color;
+}
+
+NK_API void
+nk_sdl_render_stats(const struct nk_sdl *sdl, struct nk_sdl_render_stats *stats)
+{
+    if (stats) *stats = sdl->ogl.stats;
+}
+
+NK_API int
+nk_sdl_damage_rects(const struct nk_sdl *sdl, SDL_Rect *rects, int max)
+{
+    const struct nk_sdl_device *dev = &sdl->ogl;
+    int i;
+    for (i = 0; i < dev->damage_count && i < max; ++i)
+        rects[i] = dev->damage[i];
+    return dev->damage_count;
+}
+
+NK_INTERN Uint64
+nk_sdl_hash_bytes(Uint64 hash, const void *data, nk_size size)
+{
+    /* 64-bit FNV-1a */
+    const nk_byte *bytes = (const nk_byte*)data;
+    nk_size i;
+    for (i = 0; i < size; ++i) {
+        hash ^= bytes[i];
+        hash *= 0x100000001b3ULL;
+    }
+    return hash;
+}
+
+NK_INTERN nk_size
+nk_sdl_command_size(const struct nk_command *cmd)
+{
+    /* size of the payload actually written for a command; variable length
+     * commands are cut at their last element so slack space is not hashed */
+    switch (cmd->type) {
+    case NK_COMMAND_SCISSOR:          return sizeof(struct nk_command_scissor);
+    case NK_COMMAND_LINE:             return sizeof(struct nk_command_line);
+    case NK_COMMAND_CURVE:            return sizeof(struct nk_command_curve);
+    case NK_COMMAND_RECT:             return sizeof(struct nk_command_rect);
+    case NK_COMMAND_RECT_FILLED:      return sizeof(struct nk_command_rect_filled);
+    case NK_COMMAND_RECT_MULTI_COLOR: return sizeof(struct nk_command_rect_multi_color);
+    case NK_COMMAND_CIRCLE:           return sizeof(struct nk_command_circle);
+    case NK_COMMAND_CIRCLE_FILLED:    return sizeof(struct nk_command_circle_filled);
+    case NK_COMMAND_ARC:              return sizeof(struct nk_command_arc);
+    case NK_COMMAND_ARC_FILLED:       return sizeof(struct nk_command_arc_filled);
+    case NK_COMMAND_TRIANGLE:         return sizeof(struct nk_command_triangle);
+    case NK_COMMAND_TRIANGLE_FILLED:  return sizeof(struct nk_command_triangle_filled);
+    case NK_COMMAND_POLYGON:
+        return offsetof(struct nk_command_polygon, points) +
+            sizeof(struct nk_vec2i) * ((const struct nk_command_polygon*)cmd)->point_count;
+    case NK_COMMAND_POLYGON_FILLED:
+        return offsetof(struct nk_command_polygon_filled, points) +
+            sizeof(struct nk_vec2i) * ((const struct nk_command_polygon_filled*)cmd)->point_count;
+    case NK_COMMAND_POLYLINE:
+        return offsetof(struct nk_command_polyline, points) +
+            sizeof(struct nk_vec2i) * ((const struct nk_command_polyline*)cmd)->point_count;
+    case NK_COMMAND_TEXT:
+        return offsetof(struct nk_command_text, string) +
+            (nk_size)((const struct nk_command_text*)cmd)->length;
+    case NK_COMMAND_IMAGE:            return sizeof(struct nk_command_image);
+    case NK_COMMAND_CUSTOM:           return sizeof(struct nk_command_custom);
+    default:                          return sizeof(struct nk_command);
+    }
+}
+
+NK_INTERN Uint64
+nk_sdl_hash_command(Uint64 hash, const struct nk_command *cmd)
+{
+    nk_size size = nk_sdl_command_size(cmd);
+    hash = nk_sdl_hash_bytes(hash, &cmd->type, sizeof(cmd->type));
+    return nk_sdl_hash_bytes(hash, (const nk_byte*)cmd + sizeof(struct nk_command),
+        size - sizeof(struct nk_command));
+}
+
+NK_INTERN Uint64
+nk_sdl_frame_hash(struct nk_sdl *sdl, enum nk_anti_aliasing AA)
+{
+    /* Hashes everything nk_convert and the draw loop depend on. The header's
+     * `next` offset is left out since it only encodes buffer placement; the
+     * traversal order is covered by hashing commands in sequence. */
+    const struct nk_command *cmd;
+    Uint64 hash = 0xcbf29ce484222325ULL;
+    int output[2];
+    float scale[2];
+
+    SDL_GetRendererOutputSize(sdl->renderer, &output[0], &output[1]);
+    SDL_RenderGetScale(sdl->renderer, &scale[0], &scale[1]);
+    hash = nk_sdl_hash_bytes(hash, &AA, sizeof(AA));
+    hash = nk_sdl_hash_bytes(hash, output, sizeof(output));
+    hash = nk_sdl_hash_bytes(hash, scale, sizeof(scale));
+    nk_foreach(cmd, &sdl->ctx)
+        hash = nk_sdl_hash_command(hash, cmd);
+    return hash;
+}
+
+NK_INTERN Uint64
+nk_sdl_hash_commands(Uint64 hash, const nk_byte *memory, nk_size begin, nk_size end)
+{
+    /* walks one window's sub-stream; before nk_build every `next` points
+     * forward inside the window's own range */
+    nk_size offset = begin;
+    while (offset < end) {
+        const struct nk_command *cmd = (const struct nk_command*)(memory + offset);
+        hash = nk_sdl_hash_command(hash, cmd);
+        if (cmd->next <= offset) break;
+        offset = cmd->next;
+    }
+    return hash;
+}
 
 NK_INTERN void
-nk_sdl_device_upload_atlas(const void *image, int width, int height)
+nk_sdl_push_damage(struct nk_sdl_device *dev, SDL_Rect r)
 {
-    struct nk_sdl_device *dev = &sdl.ogl;
+    /* fold overlapping rects together so no region is drawn twice */
+    int i;
+    for (i = 0; i < dev->damage_count; ++i) {
+        if (SDL_HasIntersection(&dev->damage[i], &r)) {
+            SDL_UnionRect(&dev->damage[i], &r, &r);
+            dev->damage[i] = dev->damage[--dev->damage_count];
+            nk_sdl_push_damage(dev, r);
+            return;
+        }
+    }
+    if (dev->damage_count < NK_SDL_MAX_DAMAGE_RECTS) {
+        dev->damage[dev->damage_count++] = r;
+    } else {
+        SDL_UnionRect(&dev->damage[0], &r, &dev->damage[0]);
+    }
+}
 
-    SDL_Texture *g_SDLFontTexture = SDL_CreateTexture(sdl.renderer, SDL_PIXELFORMAT_ARGB8888, SDL_TEXTUREACCESS_STATIC, width, height);
-    if (g_SDLFontTexture == NULL) {
-        SDL_Log("error creating texture");
+NK_INTERN void
+nk_sdl_add_damage(struct nk_sdl_device *dev, struct nk_rect bounds)
+{
+    /* pad for anti-aliased fringes and clamp to the target, which also keeps
+     * the clip rects derived from damage valid for NK_SDL_CLAMP_CLIP_RECT */
+    SDL_Rect r;
+    int x0, y0, x1, y1;
+    x0 = NK_MAX((int)bounds.x - 2, 0);
+    y0 = NK_MAX((int)bounds.y - 2, 0);
+    x1 = NK_MIN((int)(bounds.x + bounds.w) + 3, dev->target_bounds.w);
+    y1 = NK_MIN((int)(bounds.y + bounds.h) + 3, dev->target_bounds.h);
+    if (x1 <= x0 || y1 <= y0) return;
+    r.x = x0; r.y = y0; r.w = x1 - x0; r.h = y1 - y0;
+    nk_sdl_push_damage(dev, r);
+}
+
+NK_INTERN void
+nk_sdl_track_damage(struct nk_sdl *sdl)
+{
+    struct nk_sdl_device *dev = &sdl->ogl;
+    struct nk_sdl_window_state current[NK_SDL_MAX_TRACKED_WINDOWS];
+    const nk_byte *memory = (const nk_byte*)sdl->ctx.memory.memory.ptr;
+    const struct nk_window *win;
+    int count = 0, index = 0, i, j;
+
+    /* once nk_build ran the window command lists are linked into one, and a
+     * software cursor is drawn as an overlay nobody owns */
+    if (sdl->ctx.build || sdl->ctx.style.cursor_visible)
+        dev->damage_full = nk_true;
+
+    for (win = sdl->ctx.begin; win; win = win->next, ++index) {
+        struct nk_sdl_window_state *state;
+        if (win->buffer.last == win->buffer.begin || (win->flags & NK_WINDOW_HIDDEN) ||
+            win->seq != sdl->ctx.seq)
+            continue;
+        if (count == NK_SDL_MAX_TRACKED_WINDOWS) {
+            dev->damage_full = nk_true;
+            break;
+        }
+        state = &current[count++];
+        state->name = win->name;
+        state->bounds = win->bounds;
+        state->hash = nk_sdl_hash_bytes(0xcbf29ce484222325ULL, &index, sizeof(index));
+        state->hash = nk_sdl_hash_bytes(state->hash, &win->bounds, sizeof(win->bounds));
+        state->hash = nk_sdl_hash_commands(state->hash, memory, win->buffer.begin, win->buffer.end);
+        if (win->popup.buf.active && win->popup.win) {
+            const struct nk_rect *p = &win->popup.win->bounds;
+            float x1 = NK_MAX(state->bounds.x + state->bounds.w, p->x + p->w);
+            float y1 = NK_MAX(state->bounds.y + state->bounds.h, p->y + p->h);
+            state->bounds.x = NK_MIN(state->bounds.x, p->x);
+            state->bounds.y = NK_MIN(state->bounds.y, p->y);
+            state->bounds.w = x1 - state->bounds.x;
+            state->bounds.h = y1 - state->bounds.y;
+            state->hash = nk_sdl_hash_commands(state->hash, memory,
+                win->popup.buf.begin, win->popup.buf.end);
+        }
+    }
+
+    dev->damage_count = 0;
+    if (dev->damage_full) {
+        dev->damage[0] = dev->target_bounds;
+        dev->damage_count = 1;
+        dev->damage_full = nk_false;
+    } else {
+        /* changed, moved, re-ordered or new windows damage where they are now
+         * and where they were; vanished windows only where they were */
+        for (i = 0; i < count; ++i) {
+            const struct nk_sdl_window_state *prev = NULL;
+            for (j = 0; j < dev->window_count; ++j) {
+                if (dev->windows[j].name == current[i].name) {
+                    prev = &dev->windows[j];
+                    break;
+                }
+            }
+            if (prev && prev->hash == current[i].hash) continue;
+            if (prev) nk_sdl_add_damage(dev, prev->bounds);
+            nk_sdl_add_damage(dev, current[i].bounds);
+        }
+        for (j = 0; j < dev->window_count; ++j) {
+            for (i = 0; i < count; ++i)
+                if (dev->windows[j].name == current[i].name) break;
+            if (i == count) nk_sdl_add_damage(dev, dev->windows[j].bounds);
+        }
+    }
+    memcpy(dev->windows, current, sizeof(current[0]) * (nk_size)count);
+    dev->window_count = count;
+}
+
+NK_INTERN void
+nk_sdl_prepare_target(struct nk_sdl *sdl)
+{
+    struct nk_sdl_device *dev = &sdl->ogl;
+    int w, h;
+    float sx, sy;
+    SDL_GetRendererOutputSize(sdl->renderer, &w, &h);
+    SDL_RenderGetScale(sdl->renderer, &sx, &sy);
+    dev->target_bounds.x = 0;
+    dev->target_bounds.y = 0;
+    dev->target_bounds.w = (int)((float)w / sx + 0.5f);
+    dev->target_bounds.h = (int)((float)h / sy + 0.5f);
+    if (dev->target && dev->target_w == w && dev->target_h == h) return;
+
+    if (dev->target) SDL_DestroyTexture(dev->target);
+    dev->target = SDL_CreateTexture(sdl->renderer, SDL_PIXELFORMAT_ARGB8888,
+        SDL_TEXTUREACCESS_TARGET, w, h);
+    if (dev->target == NULL) {
+        SDL_Log("error creating damage render target: %s", SDL_GetError());
+        sdl->damage_tracking = nk_false;
         return;
     }
-    SDL_UpdateTexture(g_SDLFontTexture, NULL, image, 4 * width);
-    SDL_SetTextureBlendMode(g_SDLFontTexture, SDL_BLENDMODE_BLEND);
-    dev->font_tex = g_SDLFontTexture;
+    SDL_SetTextureBlendMode(dev->target, SDL_BLENDMODE_NONE);
+    dev->target_w = w;
+    dev->target_h = h;
+    dev->damage_full = nk_true;
 }
 
-NK_API void
-nk_sdl_render(enum nk_anti_aliasing AA)
+NK_INTERN nk_bool
+nk_sdl_rect_equal(const SDL_Rect *a, const SDL_Rect *b)
 {
-    /* setup global state */
-    struct nk_sdl_device *dev = &sdl.ogl;
+    return a->x == b->x && a->y == b->y && a->w == b->w && a->h == b->h;
+}
 
-    {
-        SDL_Rect saved_clip;
-#ifdef NK_SDL_CLAMP_CLIP_RECT
-        SDL_Rect viewport;
-#endif
-        SDL_bool clipping_enabled;
-        int vs = sizeof(struct nk_sdl_vertex);
-        size_t vp = offsetof(struct nk_sdl_vertex, position);
-        size_t vt = offsetof(struct nk_sdl_vertex, uv);
-        size_t vc = offsetof(struct nk_sdl_vertex, col);
-
-        /* convert from command queue into draw list and draw to screen */
-        const struct nk_draw_command *cmd;
-        const nk_draw_index *offset = NULL;
-        struct nk_buffer vbuf, ebuf;
-
-        /* fill converting configuration */
-        struct nk_convert_config config;
-        static const struct nk_draw_vertex_layout_element vertex_layout[] = {
-            {NK_VERTEX_POSITION, NK_FORMAT_FLOAT, NK_OFFSETOF(struct nk_sdl_vertex, position)},
-            {NK_VERTEX_TEXCOORD, NK_FORMAT_FLOAT, NK_OFFSETOF(struct nk_sdl_vertex, uv)},
-            {NK_VERTEX_COLOR, NK_FORMAT_R8G8B8A8, NK_OFFSETOF(struct nk_sdl_vertex, col)},
-            {NK_VERTEX_LAYOUT_END}
-        };
-        NK_MEMSET(&config, 0, sizeof(config));
-        config.vertex_layout = vertex_layout;
-        config.vertex_size = sizeof(struct nk_sdl_vertex);
-        config.vertex_alignment = NK_ALIGNOF(struct nk_sdl_vertex);
-        config.tex_null = dev->tex_null;
-        config.circle_segment_count = 22;
-        config.curve_segment_count = 22;
-        config.arc_segment_count = 22;
-        config.global_alpha = 1.0f;
-        config.shape_AA = AA;
-        config.line_AA = AA;
+NK_INTERN void
+nk_sdl_batch_command(struct nk_sdl_device *dev, const struct nk_draw_command *cmd,
+    unsigned int offset, const SDL_Rect *viewport)
+{
+    /* Consecutive draw commands sharing a texture are merged when they share
+     * a clip rect, or when the geometry of both lies entirely inside its own
+     * clip rect, in which case the union of the clip rects is just as good.
+     * Each batch records the vertex range it touches, and its indices are
+     * rebased onto that range so the draw call only passes those vertices. */
+    const struct nk_sdl_vertex *vertices = (const struct nk_sdl_vertex*)nk_buffer_memory_const(&dev->vbuf);
+    const nk_draw_index *indices = (const nk_draw_index*)nk_buffer_memory_const(&dev->ebuf);
+    struct nk_sdl_batch *batch = NULL;
+    SDL_Rect r;
+    unsigned int i, vmin = ~0u, vmax = 0;
+    float x0 = 1e30f, y0 = 1e30f, x1 = -1e30f, y1 = -1e30f;
+    nk_bool contained;
 
-        /* convert shapes into vertexes */
-        nk_buffer_init_default(&vbuf);
-        nk_buffer_init_default(&ebuf);
-        nk_convert(&sdl.ctx, &dev->cmds, &vbuf, &ebuf, &config);
+    if (!cmd->elem_count) return;
+    dev->stats.commands++;
+    if (dev->batch_count)
+        batch = (struct nk_sdl_batch*)nk_buffer_memory(&dev->batches) + dev->batch_count - 1;
+
+    r.x = cmd->clip_rect.x;
+    r.y = cmd->clip_rect.y;
+    r.w = cmd->clip_rect.w;
+    r.h = cmd->clip_rect.h;
+    if (viewport) {
+        if (r.x < 0) {
+            r.w += r.x;
+            r.x = 0;
+        }
+        if (r.y < 0) {
+            r.h += r.y;
+            r.y = 0;
+        }
+        if (r.h > viewport->h) {
+            r.h = viewport->h;
+        }
+        if (r.w > viewport->w) {
+            r.w = viewport->w;
+        }
+    }
+    for (i = offset; i < offset + cmd->elem_count; ++i) {
+        const struct nk_sdl_vertex *v = &vertices[indices[i]];
+        vmin = NK_MIN(vmin, (unsigned int)indices[i]);
+        vmax = NK_MAX(vmax, (unsigned int)indices[i]);
+        x0 = NK_MIN(x0, v->position[0]); x1 = NK_MAX(x1, v->position[0]);
+        y0 = NK_MIN(y0, v->position[1]); y1 = NK_MAX(y1, v->position[1]);
+    }
+    contained = x0 >= (float)r.x && y0 >= (float)r.y &&
+        x1 <= (float)(r.x + r.w) && y1 <= (float)(r.y + r.h);
 
-        /* iterate over and execute each draw command */
-        offset = (const nk_draw_index*)nk_buffer_memory_const(&ebuf);
+    if (batch && batch->texture == (SDL_Texture*)cmd->texture.ptr &&
+        (nk_sdl_rect_equal(&batch->clip, &r) || (batch->contained && contained))) {
+        if (!nk_sdl_rect_equal(&batch->clip, &r))
+            SDL_UnionRect(&batch->clip, &r, &batch->clip);
+        batch->contained = batch->contained && contained;
+        batch->index_count += cmd->elem_count;
+        batch->vertex_first = NK_MIN(batch->vertex_first, vmin);
+        batch->vertex_last = NK_MAX(batch->vertex_last, vmax);
+    } else {
+        struct nk_sdl_batch next;
+        next.texture = (SDL_Texture*)cmd->texture.ptr;
+        next.clip = r;
+        next.contained = contained;
+        next.index_offset = offset;
+        next.index_count = cmd->elem_count;
+        next.vertex_first = vmin;
+        next.vertex_last = vmax;
+        nk_buffer_push(&dev->batches, NK_BUFFER_FRONT, &next, sizeof(next),
+            NK_ALIGNOF(struct nk_sdl_batch));
+        dev->batch_count++;
+    }
+}
 
-        clipping_enabled = SDL_RenderIsClipEnabled(sdl.renderer);
-        SDL_RenderGetClipRect(sdl.renderer, &saved_clip);
+NK_INTERN void
+nk_sdl_build_batches(struct nk_sdl *sdl, const struct nk_draw_command *commands, int command_count)
+{
+    /* batches either the draw list nk_sdl_render converted into dev->cmds or,
+     * when `commands` is given, draw commands converted elsewhere */
+    struct nk_sdl_device *dev = &sdl->ogl;
+    const struct nk_draw_command *cmd;
+    const SDL_Rect *clamp = NULL;
+    unsigned int offset = 0;
+    nk_draw_index *indices;
+    struct nk_sdl_batch *b;
+    int n;
 #ifdef NK_SDL_CLAMP_CLIP_RECT
-        SDL_RenderGetViewport(sdl.renderer, &viewport);
+    SDL_Rect viewport;
+    SDL_RenderGetViewport(sdl->renderer, &viewport);
+    clamp = &viewport;
 #endif
 
-        nk_draw_foreach(cmd, &sdl.ctx, &dev->cmds)
+    nk_buffer_clear(&dev->batches);
+    dev->batch_count = 0;
+    dev->stats.commands = 0;
+
+    if (commands) {
+        for (n = 0; n < command_count; ++n) {
+            nk_sdl_batch_command(dev, &commands[n], offset, clamp);
+            offset += commands[n].elem_count;
+        }
+    } else {
+        nk_draw_foreach(cmd, &sdl->ctx, &dev->cmds)
         {
-            if (!cmd->elem_count) continue;
-
-            {
-                SDL_Rect r;
-                r.x = cmd->clip_rect.x;
-                r.y = cmd->clip_rect.y;
-                r.w = cmd->clip_rect.w;
-                r.h = cmd->clip_rect.h;
-#ifdef NK_SDL_CLAMP_CLIP_RECT
-                if (r.x < 0) {
-                    r.w += r.x;
-                    r.x = 0;
-                }
-                if (r.y < 0) {
-                    r.h += r.y;
-                    r.y = 0;
-                }
-                if (r.h > viewport.h) {
-                    r.h = viewport.h;
-                }
-                if (r.w > viewport.w) {
-                    r.w = viewport.w;
-                }
-#endif
-                SDL_RenderSetClipRect(sdl.renderer, &r);
-            }
+            nk_sdl_batch_command(dev, cmd, offset, clamp);
+            offset += cmd->elem_count;
+        }
+    }
+
+    /* rebase indices now that every batch's vertex range is final */
+    indices = (nk_draw_index*)nk_buffer_memory(&dev->ebuf);
+    b = (struct nk_sdl_batch*)nk_buffer_memory(&dev->batches);
+    for (n = 0; n < dev->batch_count; ++n) {
+        unsigned int i;
+        for (i = b[n].index_offset; i < b[n].index_offset + b[n].index_count; ++i)
+            indices[i] = (nk_draw_index)(indices[i] - b[n].vertex_first);
+    }
+}
 
-            {
-                const void *vertices = nk_buffer_memory_const(&vbuf);
+NK_INTERN void
+nk_sdl_draw(struct nk_sdl *sdl, const SDL_Rect *damage)
+{
+    struct nk_sdl_device *dev = &sdl->ogl;
+    SDL_Rect saved_clip;
+    SDL_Rect current_clip;
+    nk_bool clip_set = nk_false;
+    SDL_bool clipping_enabled;
+    int vs = sizeof(struct nk_sdl_vertex);
+    size_t vp = offsetof(struct nk_sdl_vertex, position);
+    size_t vt = offsetof(struct nk_sdl_vertex, uv);
+    size_t vc = offsetof(struct nk_sdl_vertex, col);
 
-                SDL_RenderGeometryRaw(sdl.renderer,
-                        (SDL_Texture *)cmd->texture.ptr,
-                        (const float*)((const nk_byte*)vertices + vp), vs,
-                        (const SDL_Color*)((const nk_byte*)vertices + vc), vs,
-                        (const float*)((const nk_byte*)vertices + vt), vs,
-                        (vbuf.needed / vs),
-                        (void *) offset, cmd->elem_count, 2);
+    const nk_draw_index *indices = (const nk_draw_index*)nk_buffer_memory_const(&dev->ebuf);
+    const nk_byte *vertices = (const nk_byte*)nk_buffer_memory_const(&dev->vbuf);
+    const struct nk_sdl_batch *batch = (const struct nk_sdl_batch*)nk_buffer_memory_const(&dev->batches);
+    int n;
 
-                offset += cmd->elem_count;
-            }
+    clipping_enabled = SDL_RenderIsClipEnabled(sdl->renderer);
+    SDL_RenderGetClipRect(sdl->renderer, &saved_clip);
+
+    /* iterate over and execute each batch */
+    for (n = 0; n < dev->batch_count; ++n, ++batch) {
+        SDL_Rect r = batch->clip;
+        const nk_byte *first = vertices + (nk_size)batch->vertex_first * (nk_size)vs;
+
+        /* batches entirely outside the damaged region are skipped */
+        if (damage && !SDL_IntersectRect(&r, damage, &r))
+            continue;
+        if (!clip_set || !nk_sdl_rect_equal(&r, &current_clip)) {
+            SDL_RenderSetClipRect(sdl->renderer, &r);
+            current_clip = r;
+            clip_set = nk_true;
+            dev->stats.clip_changes++;
         }
 
-        SDL_RenderSetClipRect(sdl.renderer, &saved_clip);
-        if (!clipping_enabled) {
-            SDL_RenderSetClipRect(sdl.renderer, NULL);
+        SDL_RenderGeometryRaw(sdl->renderer,
+                batch->texture,
+                (const float*)(first + vp), vs,
+                (const SDL_Color*)(first + vc), vs,
+                (const float*)(first + vt), vs,
+                (int)(batch->vertex_last - batch->vertex_first + 1),
+                (const void*)(indices + batch->index_offset), (int)batch->index_count,
+                sizeof(nk_draw_index));
+        dev->stats.draw_calls++;
+    }
+
+    SDL_RenderSetClipRect(sdl->renderer, &saved_clip);
+    if (!clipping_enabled) {
+        SDL_RenderSetClipRect(sdl->renderer, NULL);
+    }
+}
+
+NK_INTERN void
+nk_sdl_draw_damage(struct nk_sdl *sdl)
+{
+    /* only damaged regions of the persistent target are cleared and redrawn,
+     * then the whole target is copied to the current render target */
+    struct nk_sdl_device *dev = &sdl->ogl;
+    SDL_Texture *previous = SDL_GetRenderTarget(sdl->renderer);
+    SDL_BlendMode blend;
+    float sx, sy;
+    int i;
+
+    SDL_RenderGetScale(sdl->renderer, &sx, &sy);
+    SDL_SetRenderTarget(sdl->renderer, dev->target);
+    SDL_RenderSetScale(sdl->renderer, sx, sy);
+    SDL_GetRenderDrawBlendMode(sdl->renderer, &blend);
+    for (i = 0; i < dev->damage_count; ++i) {
+        /* SDL_RenderClear ignores the clip rect, so fill instead */
+        SDL_SetRenderDrawBlendMode(sdl->renderer, SDL_BLENDMODE_NONE);
+        SDL_SetRenderDrawColor(sdl->renderer, dev->clear_color.r, dev->clear_color.g,
+            dev->clear_color.b, dev->clear_color.a);
+        SDL_RenderFillRect(sdl->renderer, &dev->damage[i]);
+        SDL_SetRenderDrawBlendMode(sdl->renderer, blend);
+        nk_sdl_draw(sdl, &dev->damage[i]);
+    }
+    SDL_SetRenderTarget(sdl->renderer, previous);
+    SDL_RenderCopy(sdl->renderer, dev->target, NULL, NULL);
+}
+
+NK_API nk_bool
+nk_sdl_render(struct nk_sdl *sdl, enum nk_anti_aliasing AA)
+{
+    /* setup global state */
+    struct nk_sdl_device *dev = &sdl->ogl;
+    nk_bool unchanged = nk_false;
+
+    /* per-window damage has to be collected before anything walks the
+     * command queue, since nk_build links the window command lists */
+    if (sdl->damage_tracking) {
+        nk_sdl_prepare_target(sdl);
+        if (sdl->damage_tracking) {
+            nk_sdl_track_damage(sdl);
+            unchanged = dev->damage_count == 0;
         }
+    }
+    if (sdl->frame_diff != NK_SDL_FRAME_DIFF_OFF) {
+        Uint64 hash = nk_sdl_frame_hash(sdl, AA);
+        unchanged = unchanged || (dev->frame_valid && hash == dev->frame_hash);
+        dev->frame_hash = hash;
+        dev->frame_valid = nk_true;
+    }
+    if (unchanged && sdl->frame_diff == NK_SDL_FRAME_DIFF_SKIP && !sdl->damage_tracking) {
+        nk_clear(&sdl->ctx);
+        return nk_false;
+    }
+
+    /* convert from command queue into draw list, reusing last frame's
+     * storage; an unchanged frame keeps last frame's output as it is */
+    if (!unchanged) {
+        struct nk_buffer *vbuf = &dev->vbuf;
+        struct nk_buffer *ebuf = &dev->ebuf;
+
+        /* the rest of the configuration was set up by nk_sdl_init */
+        struct nk_convert_config *config = &dev->config;
+        config->shape_AA = AA;
+        config->line_AA = AA;
 
-        nk_clear(&sdl.ctx);
+        /* convert shapes into vertexes */
         nk_buffer_clear(&dev->cmds);
-        nk_buffer_free(&vbuf);
-        nk_buffer_free(&ebuf);
+        nk_buffer_clear(vbuf);
+        nk_buffer_clear(ebuf);
+        NK_SDL_PROFILE_BEGIN(sdl, convert);
+        NK_SDL_CONVERT(&sdl->ctx, &dev->cmds, vbuf, ebuf, config);
+        NK_SDL_PROFILE_END(sdl, convert);
+        NK_SDL_PROFILE_BUFFERS(sdl, &dev->cmds, vbuf, ebuf);
+        if (sdl->font && sdl->font->update)
+            sdl->font->update(sdl, sdl->font->update_userdata);
+        if (vbuf->needed > dev->vbuf_high_water)
+            dev->vbuf_high_water = vbuf->needed;
+        if (ebuf->needed > dev->ebuf_high_water)
+            dev->ebuf_high_water = ebuf->needed;
+        nk_sdl_build_batches(sdl, NULL, 0);
     }
+
+    /* draw to screen */
+    dev->stats.draw_calls = 0;
+    dev->stats.clip_changes = 0;
+    NK_SDL_PROFILE_BEGIN(sdl, submit);
+    if (sdl->damage_tracking)
+        nk_sdl_draw_damage(sdl);
+    else nk_sdl_draw(sdl, NULL);
+    NK_SDL_PROFILE_END(sdl, submit);
+    NK_SDL_PROFILE_DRAW(sdl, dev->stats.draw_calls, dev->stats.clip_changes);
+
+    nk_clear(&sdl->ctx);
+    return sdl->damage_tracking ? dev->damage_count > 0 : nk_true;
+}
+
+NK_API void
+nk_sdl_render_draw_data(struct nk_sdl *sdl, const void *vertices, int vertex_count,
+    const nk_draw_index *indices, int index_count,
+    const struct nk_draw_command *commands, int command_count)
+{
+    struct nk_sdl_device *dev = &sdl->ogl;
+
+    /* batching rebases indices in place, so both arrays are copied into the
+     * device buffers first */
+    nk_buffer_clear(&dev->vbuf);
+    nk_buffer_clear(&dev->ebuf);
+    if (vertex_count > 0)
+        nk_buffer_push(&dev->vbuf, NK_BUFFER_FRONT, vertices,
+            (nk_size)vertex_count * sizeof(struct nk_sdl_vertex), NK_ALIGNOF(struct nk_sdl_vertex));
+    if (index_count > 0)
+        nk_buffer_push(&dev->ebuf, NK_BUFFER_FRONT, indices,
+            (nk_size)index_count * sizeof(nk_draw_index), NK_ALIGNOF(nk_draw_index));
+    nk_sdl_build_batches(sdl, commands, command_count);
+
+    /* the buffers no longer hold what nk_sdl_render converted last */
+    dev->frame_valid = nk_false;
+    dev->damage_full = nk_true;
+
+    dev->stats.draw_calls = 0;
+    dev->stats.clip_changes = 0;
+    NK_SDL_PROFILE_BEGIN(sdl, submit);
+    nk_sdl_draw(sdl, NULL);
+    NK_SDL_PROFILE_END(sdl, submit);
+    NK_SDL_PROFILE_DRAW(sdl, dev->stats.draw_calls, dev->stats.clip_changes);
 }
 
 static void
 nk_sdl_clipboard_paste(nk_handle usr, struct nk_text_edit *edit)
 {
-    const char *text = SDL_GetClipboardText();
-    if (text) nk_textedit_paste(edit, text, nk_strlen(text));
+    char *text = SDL_GetClipboardText();
+    if (text) {
+        nk_textedit_paste(edit, text, nk_strlen(text));
+        SDL_free(text);
+    }
     (void)usr;
 }
 
@@ -214,7 +1011,13 @@ nk_sdl_clipboard_copy(nk_handle usr, const char *text, int len)
 }
 
 NK_API struct nk_context*
-nk_sdl_init(SDL_Window *win, SDL_Renderer *renderer)
+nk_sdl_init(struct nk_sdl *sdl, SDL_Window *win, SDL_Renderer *renderer)
+{
+    return nk_sdl_init_allocator(sdl, win, renderer, NULL);
+}
+
+NK_API struct nk_context*
+nk_sdl_init_allocator(struct nk_sdl *sdl, SDL_Window *win, SDL_Renderer *renderer, const struct nk_allocator *alloc)
 {
 #ifndef NK_SDL_CLAMP_CLIP_RECT
     SDL_RendererInfo info;
@@ -235,110 +1038,520 @@ nk_sdl_init(SDL_Window *win, SDL_Renderer *renderer)
         );
     }
 #endif
-    sdl.win = win;
-    sdl.renderer = renderer;
-    nk_init_default(&sdl.ctx, 0);
-    sdl.ctx.clip.copy = nk_sdl_clipboard_copy;
-    sdl.ctx.clip.paste = nk_sdl_clipboard_paste;
-    sdl.ctx.clip.userdata = nk_handle_ptr(0);
-    nk_buffer_init_default(&sdl.ogl.cmds);
-    return &sdl.ctx;
+    memset(sdl, 0, sizeof(*sdl));
+    sdl->win = win;
+    sdl->window_id = SDL_GetWindowID(win);
+    sdl->renderer = renderer;
+    if (alloc) {
+        sdl->alloc = *alloc;
+        nk_init(&sdl->ctx, &sdl->alloc, 0);
+    } else {
+        nk_init_default(&sdl->ctx, 0);
+        sdl->alloc = sdl->ctx.memory.pool;
+    }
+    sdl->ctx.clip.copy = nk_sdl_clipboard_copy;
+    sdl->ctx.clip.paste = nk_sdl_clipboard_paste;
+    sdl->ctx.clip.userdata = nk_handle_ptr(0);
+    nk_buffer_init(&sdl->ogl.cmds, &sdl->alloc, NK_BUFFER_DEFAULT_INITIAL_SIZE);
+    nk_buffer_init(&sdl->ogl.vbuf, &sdl->alloc, NK_BUFFER_DEFAULT_INITIAL_SIZE);
+    nk_buffer_init(&sdl->ogl.ebuf, &sdl->alloc, NK_BUFFER_DEFAULT_INITIAL_SIZE);
+    nk_buffer_init(&sdl->ogl.batches, &sdl->alloc, NK_BUFFER_DEFAULT_INITIAL_SIZE);
+    sdl->ogl.config.vertex_layout = NK_SDL_VERTEX_LAYOUT;
+    sdl->ogl.config.vertex_size = NK_SDL_VERTEX_SIZE;
+    sdl->ogl.config.vertex_alignment = NK_SDL_VERTEX_ALIGNMENT;
+    sdl->ogl.config.circle_segment_count = 22;
+    sdl->ogl.config.curve_segment_count = 22;
+    sdl->ogl.config.arc_segment_count = 22;
+    sdl->ogl.config.global_alpha = 1.0f;
+    return &sdl->ctx;
 }
 
 NK_API void
-nk_sdl_font_stash_begin(struct nk_font_atlas **atlas)
+nk_sdl_font_stash_begin(struct nk_sdl *sdl, struct nk_font_atlas **atlas)
 {
-    nk_font_atlas_init_default(&sdl.atlas);
-    nk_font_atlas_begin(&sdl.atlas);
-    *atlas = &sdl.atlas;
+    /* a new atlas replaces the current one; contexts sharing the old one
+     * keep it alive until they let go of it too */
+    struct nk_sdl_font *font;
+    nk_sdl_font_release(sdl->font);
+    font = (struct nk_sdl_font*)sdl->alloc.alloc(sdl->alloc.userdata, 0, sizeof(*font));
+    sdl->font = font;
+    *atlas = NULL;
+    if (!font) return;
+    memset(font, 0, sizeof(*font));
+    font->alloc = sdl->alloc;
+    font->renderer = sdl->renderer;
+    font->refs = 1;
+    nk_font_atlas_init(&font->atlas, &sdl->alloc);
+    nk_font_atlas_begin(&font->atlas);
+    *atlas = &font->atlas;
 }
 
 NK_API void
-nk_sdl_font_stash_end(void)
+nk_sdl_font_stash_end(struct nk_sdl *sdl)
 {
+    struct nk_sdl_font *font = sdl->font;
     const void *image; int w, h;
-    image = nk_font_atlas_bake(&sdl.atlas, &w, &h, NK_FONT_ATLAS_RGBA32);
-    nk_sdl_device_upload_atlas(image, w, h);
-    nk_font_atlas_end(&sdl.atlas, nk_handle_ptr(sdl.ogl.font_tex), &sdl.ogl.tex_null);
-    if (sdl.atlas.default_font)
-        nk_style_set_font(&sdl.ctx, &sdl.atlas.default_font->handle);
+    if (!font) return;
+    image = NK_SDL_FONT_BAKE(&font->atlas, &w, &h);
+    font->texture = nk_sdl_device_upload_atlas(sdl->renderer, image, w, h);
+    nk_font_atlas_end(&font->atlas, nk_handle_ptr(font->texture), &font->tex_null);
+    sdl->ogl.config.tex_null = font->tex_null;
+    if (font->atlas.default_font)
+        nk_style_set_font(&sdl->ctx, &font->atlas.default_font->handle);
+}
+
+NK_API nk_handle
+nk_sdl_font_dynamic(struct nk_sdl *sdl, int width, int height, struct nk_vec2 white_uv,
+    void (*update)(struct nk_sdl *sdl, void *userdata), void *userdata)
+{
+    struct nk_sdl_font *font;
+    nk_sdl_font_release(sdl->font);
+    font = (struct nk_sdl_font*)sdl->alloc.alloc(sdl->alloc.userdata, 0, sizeof(*font));
+    sdl->font = font;
+    if (!font) return nk_handle_ptr(0);
+    memset(font, 0, sizeof(*font));
+    font->alloc = sdl->alloc;
+    font->renderer = sdl->renderer;
+    font->refs = 1;
+    font->update = update;
+    font->update_userdata = userdata;
+    /* left empty, only so nk_sdl_font_release can treat both kinds alike */
+    nk_font_atlas_init(&font->atlas, &sdl->alloc);
+    /* streaming, since parts of it are rewritten while running */
+    font->texture = SDL_CreateTexture(sdl->renderer, SDL_PIXELFORMAT_RGBA32,
+        SDL_TEXTUREACCESS_STREAMING, width, height);
+    if (!font->texture) {
+        SDL_Log("error creating texture");
+        return nk_handle_ptr(0);
+    }
+    SDL_SetTextureBlendMode(font->texture, SDL_BLENDMODE_BLEND);
+    font->tex_null.texture = nk_handle_ptr(font->texture);
+    font->tex_null.uv = white_uv;
+    sdl->ogl.config.tex_null = font->tex_null;
+    nk_sdl_invalidate(sdl);
+    return nk_handle_ptr(font->texture);
+}
+
+NK_API void
+nk_sdl_font_update(struct nk_sdl *sdl, const void *pixels, int pitch, int x, int y, int w, int h)
+{
+    SDL_Rect rect;
+    if (!sdl->font || !sdl->font->texture || w <= 0 || h <= 0) return;
+    rect.x = x; rect.y = y; rect.w = w; rect.h = h;
+    SDL_UpdateTexture(sdl->font->texture, &rect, pixels, pitch);
+}
+
+NK_API nk_bool
+nk_sdl_share_font(struct nk_sdl *sdl, struct nk_sdl *source)
+{
+    /* SDL textures belong to the renderer that created them */
+    struct nk_sdl_font *font = source->font;
+    if (!font || font->renderer != sdl->renderer) return nk_false;
+    if (sdl->font == font) return nk_true;
+    font->refs++;
+    nk_sdl_font_release(sdl->font);
+    sdl->font = font;
+    sdl->ogl.config.tex_null = font->tex_null;
+    if (font->atlas.default_font)
+        nk_style_set_font(&sdl->ctx, &font->atlas.default_font->handle);
+    nk_sdl_invalidate(sdl);
+    return nk_true;
+}
+
+/* one transparent texel around each image keeps linear filtering from
+ * picking up its neighbours */
+#define NK_SDL_IMAGE_PADDING 1
+
+NK_INTERN void*
+nk_sdl_image_malloc(nk_handle unused, void *old, nk_size size)
+{
+    (void)unused; (void)old;
+    return SDL_malloc(size);
+}
+
+NK_INTERN void
+nk_sdl_image_mfree(nk_handle unused, void *ptr)
+{
+    (void)unused;
+    SDL_free(ptr);
+}
+
+NK_API void
+nk_sdl_images_init(struct nk_sdl_images *images, SDL_Renderer *renderer, const struct nk_allocator *alloc)
+{
+    memset(images, 0, sizeof(*images));
+    images->renderer = renderer;
+    if (alloc) {
+        images->alloc = *alloc;
+    } else {
+        images->alloc.userdata = nk_handle_ptr(0);
+        images->alloc.alloc = nk_sdl_image_malloc;
+        images->alloc.free = nk_sdl_image_mfree;
+    }
+    images->frame = 2;
+}
+
+NK_API void
+nk_sdl_images_free(struct nk_sdl_images *images)
+{
+    int i;
+    for (i = 0; i < images->page_count; ++i) {
+        struct nk_sdl_image_page *page = &images->pages[i];
+        if (page->texture) SDL_DestroyTexture(page->texture);
+        if (page->pixels) images->alloc.free(images->alloc.userdata, page->pixels);
+    }
+    if (images->entries) images->alloc.free(images->alloc.userdata, images->entries);
+    memset(images, 0, sizeof(*images));
+}
+
+NK_INTERN struct nk_sdl_image_entry*
+nk_sdl_image_find(struct nk_sdl_images *images, int id)
+{
+    /* ids carry the entry's generation above the index, so an id kept past
+     * an eviction does not find the image now stored in its entry */
+    struct nk_sdl_image_entry *e;
+    int index = id & 0xffff;
+    if (id < 0 || index >= images->entry_count) return NULL;
+    e = &images->entries[index];
+    if (e->page < 0 || (e->generation & 0x7fff) != ((unsigned)id >> 16)) return NULL;
+    return e;
+}
+
+NK_INTERN struct nk_sdl_image_page*
+nk_sdl_image_new_page(struct nk_sdl_images *images)
+{
+    struct nk_sdl_image_page *page;
+    nk_size size = (nk_size)NK_SDL_IMAGE_PAGE_SIZE * NK_SDL_IMAGE_PAGE_SIZE * 4;
+    if (images->page_count >= NK_SDL_IMAGE_MAX_PAGES) return NULL;
+    page = &images->pages[images->page_count];
+    memset(page, 0, sizeof(*page));
+    page->pixels = (Uint32*)images->alloc.alloc(images->alloc.userdata, 0, size);
+    if (!page->pixels) return NULL;
+    /* streaming, since rows are rewritten while running */
+    page->texture = SDL_CreateTexture(images->renderer, SDL_PIXELFORMAT_RGBA32,
+        SDL_TEXTUREACCESS_STREAMING, NK_SDL_IMAGE_PAGE_SIZE, NK_SDL_IMAGE_PAGE_SIZE);
+    if (!page->texture) {
+        SDL_Log("error creating texture");
+        images->alloc.free(images->alloc.userdata, page->pixels);
+        page->pixels = NULL;
+        return NULL;
+    }
+    SDL_SetTextureBlendMode(page->texture, SDL_BLENDMODE_BLEND);
+    /* the texture starts out undefined, so all of it goes up first */
+    memset(page->pixels, 0, size);
+    page->dirty.w = page->dirty.h = NK_SDL_IMAGE_PAGE_SIZE;
+    images->page_count++;
+    return page;
+}
+
+NK_INTERN void
+nk_sdl_image_evict(struct nk_sdl_images *images, int page, int shelf)
+{
+    int i;
+    for (i = 0; i < images->entry_count; ++i) {
+        struct nk_sdl_image_entry *e = &images->entries[i];
+        if (e->page == page && e->shelf == shelf) {
+            e->page = -1;
+            e->generation++;
+        }
+    }
+    images->pages[page].shelves[shelf].x = 0;
+    images->evictions++;
+}
+
+NK_INTERN nk_bool
+nk_sdl_image_place(struct nk_sdl_images *images, int w, int h, int *page_out, int *shelf_out)
+{
+    /* the tightest row with room, else a new row in any page, else a new
+     * page, else the oldest row that has not been drawn for a frame */
+    int best_page = -1, best_shelf = -1, best_height = 0;
+    int old_page = -1, old_shelf = -1;
+    Uint64 old_used = 0;
+    int p, i;
+    struct nk_sdl_image_page *page;
+
+    for (p = 0; p < images->page_count; ++p) {
+        page = &images->pages[p];
+        for (i = 0; i < page->shelf_count; ++i) {
+            const struct nk_sdl_image_shelf *s = &page->shelves[i];
+            if (s->height >= h && s->x + w <= NK_SDL_IMAGE_PAGE_SIZE &&
+                (best_shelf < 0 || s->height < best_height)) {
+                best_page = p; best_shelf = i; best_height = s->height;
+            }
+            if (s->height >= h && s->last_used + 1 < images->frame &&
+                (old_shelf < 0 || s->last_used < old_used)) {
+                old_page = p; old_shelf = i; old_used = s->last_used;
+            }
+        }
+    }
+    if (best_shelf >= 0 && best_height <= h + h / 2) goto found;
+
+    for (p = 0; p <= images->page_count; ++p) {
+        int bottom;
+        if (p == images->page_count && !nk_sdl_image_new_page(images)) break;
+        page = &images->pages[p];
+        bottom = page->shelf_count ?
+            page->shelves[page->shelf_count-1].y + page->shelves[page->shelf_count-1].height : 0;
+        if (page->shelf_count < NK_SDL_IMAGE_MAX_SHELVES && bottom + h <= NK_SDL_IMAGE_PAGE_SIZE) {
+            struct nk_sdl_image_shelf *s = &page->shelves[page->shelf_count];
+            s->y = bottom; s->height = h; s->x = 0; s->last_used = 0;
+            best_page = p; best_shelf = page->shelf_count++;
+            goto found;
+        }
+    }
+    if (best_shelf >= 0) goto found;
+    if (old_shelf < 0) return nk_false;
+    nk_sdl_image_evict(images, old_page, old_shelf);
+    best_page = old_page; best_shelf = old_shelf;
+
+found:
+    *page_out = best_page;
+    *shelf_out = best_shelf;
+    return nk_true;
 }
 
 NK_API int
-nk_sdl_handle_event(SDL_Event *evt)
+nk_sdl_image_add(struct nk_sdl_images *images, const void *pixels, int pitch, int w, int h)
 {
-    struct nk_context *ctx = &sdl.ctx;
+    const int slot_w = w + 2 * NK_SDL_IMAGE_PADDING;
+    const int slot_h = h + 2 * NK_SDL_IMAGE_PADDING;
+    struct nk_sdl_image_page *page;
+    struct nk_sdl_image_shelf *shelf;
+    struct nk_sdl_image_entry *e = NULL;
+    int p, s, x, y, row, index;
 
-    /* optional grabbing behavior */
+    if (w <= 0 || h <= 0 || slot_w > NK_SDL_IMAGE_PAGE_SIZE || slot_h > NK_SDL_IMAGE_PAGE_SIZE)
+        return -1;
+
+    /* reuse a free entry before growing the table */
+    for (index = 0; index < images->entry_count; ++index)
+        if (images->entries[index].page < 0) break;
+    if (index == images->entry_count) {
+        if (index > 0xffff) return -1; /* ids keep the index in 16 bits */
+        if (images->entry_count == images->entry_capacity) {
+            int capacity = images->entry_capacity ? images->entry_capacity * 2 : 64;
+            struct nk_sdl_image_entry *entries = (struct nk_sdl_image_entry*)images->alloc.alloc(
+                images->alloc.userdata, 0, (nk_size)capacity * sizeof(*entries));
+            if (!entries) return -1;
+            if (images->entries) {
+                memcpy(entries, images->entries, (size_t)images->entry_count * sizeof(*entries));
+                images->alloc.free(images->alloc.userdata, images->entries);
+            }
+            images->entries = entries;
+            images->entry_capacity = capacity;
+        }
+        images->entries[index].page = -1;
+        images->entries[index].generation = 0;
+        images->entry_count++;
+    }
+
+    if (!nk_sdl_image_place(images, slot_w, slot_h, &p, &s)) return -1;
+    page = &images->pages[p];
+    shelf = &page->shelves[s];
+    x = shelf->x;
+    y = shelf->y;
+    shelf->x += slot_w;
+    shelf->last_used = images->frame;
+
+    e = &images->entries[index];
+    e->page = p;
+    e->shelf = s;
+    e->x = x + NK_SDL_IMAGE_PADDING;
+    e->y = y + NK_SDL_IMAGE_PADDING;
+    e->w = w;
+    e->h = h;
+
+    /* an emptied row still holds the images it had, padding included */
+    for (row = 0; row < slot_h; ++row)
+        memset(page->pixels + (size_t)(y + row) * NK_SDL_IMAGE_PAGE_SIZE + x, 0, (size_t)slot_w * 4);
+    for (row = 0; row < h; ++row)
+        memcpy(page->pixels + (size_t)(e->y + row) * NK_SDL_IMAGE_PAGE_SIZE + e->x,
+            (const nk_byte*)pixels + (size_t)row * (size_t)pitch, (size_t)w * 4);
+
+    if (page->dirty.w > 0) {
+        SDL_Rect r;
+        r.x = x; r.y = y; r.w = slot_w; r.h = slot_h;
+        SDL_UnionRect(&page->dirty, &r, &page->dirty);
+    } else {
+        page->dirty.x = x; page->dirty.y = y;
+        page->dirty.w = slot_w; page->dirty.h = slot_h;
+    }
+    return (int)((unsigned)(e->generation & 0x7fff) << 16 | (unsigned)index);
+}
+
+NK_API nk_bool
+nk_sdl_image_get(struct nk_sdl_images *images, int id, struct nk_image *image)
+{
+    struct nk_sdl_image_entry *e = nk_sdl_image_find(images, id);
+    struct nk_sdl_image_page *page;
+    if (!e) return nk_false;
+    page = &images->pages[e->page];
+    page->shelves[e->shelf].last_used = images->frame;
+    *image = nk_subimage_ptr(page->texture, NK_SDL_IMAGE_PAGE_SIZE, NK_SDL_IMAGE_PAGE_SIZE,
+        nk_rect((float)e->x, (float)e->y, (float)e->w, (float)e->h));
+    return nk_true;
+}
+
+NK_API void
+nk_sdl_image_remove(struct nk_sdl_images *images, int id)
+{
+    /* the space is taken back when its row is emptied */
+    struct nk_sdl_image_entry *e = nk_sdl_image_find(images, id);
+    if (!e) return;
+    e->page = -1;
+    e->generation++;
+}
+
+NK_API void
+nk_sdl_images_upload(struct nk_sdl_images *images)
+{
+    int i;
+    for (i = 0; i < images->page_count; ++i) {
+        struct nk_sdl_image_page *page = &images->pages[i];
+        if (page->dirty.w <= 0) continue;
+        SDL_UpdateTexture(page->texture, &page->dirty,
+            page->pixels + (size_t)page->dirty.y * NK_SDL_IMAGE_PAGE_SIZE + page->dirty.x,
+            NK_SDL_IMAGE_PAGE_SIZE * 4);
+        page->dirty.w = page->dirty.h = 0;
+        images->uploads++;
+    }
+    images->frame++;
+}
+
+NK_INTERN nk_bool
+nk_sdl_event_for_window(const struct nk_sdl *sdl, const SDL_Event *evt)
+{
+    Uint32 id;
+    switch (evt->type) {
+    case SDL_WINDOWEVENT:     id = evt->window.windowID; break;
+    case SDL_KEYUP:
+    case SDL_KEYDOWN:         id = evt->key.windowID; break;
+    case SDL_TEXTINPUT:       id = evt->text.windowID; break;
+    case SDL_MOUSEMOTION:     id = evt->motion.windowID; break;
+    case SDL_MOUSEBUTTONUP:
+    case SDL_MOUSEBUTTONDOWN: id = evt->button.windowID; break;
+    case SDL_MOUSEWHEEL:      id = evt->wheel.windowID; break;
+    default:                  return nk_true;
+    }
+    /* events SDL could not attribute to any window go to every context */
+    return id == 0 || id == sdl->window_id;
+}
+
+/* applies a grab/ungrab requested by the last frame */
+NK_INTERN void
+nk_sdl_update_grab(struct nk_sdl *sdl)
+{
+    struct nk_context *ctx = &sdl->ctx;
     if (ctx->input.mouse.grab) {
         SDL_SetRelativeMouseMode(SDL_TRUE);
         ctx->input.mouse.grab = 0;
     } else if (ctx->input.mouse.ungrab) {
         int x = (int)ctx->input.mouse.prev.x, y = (int)ctx->input.mouse.prev.y;
         SDL_SetRelativeMouseMode(SDL_FALSE);
-        SDL_WarpMouseInWindow(sdl.win, x, y);
+        SDL_WarpMouseInWindow(sdl->win, x, y);
         ctx->input.mouse.ungrab = 0;
     }
+}
+
+/* `state` is SDL_GetKeyboardState, which only changes when events are pumped */
+NK_INTERN void
+nk_sdl_handle_key(struct nk_context *ctx, const SDL_KeyboardEvent *key, const Uint8 *state)
+{
+    int down = key->type == SDL_KEYDOWN;
+    switch(key->keysym.sym)
+    {
+        case SDLK_RSHIFT: /* RSHIFT & LSHIFT share same routine */
+        case SDLK_LSHIFT:    nk_input_key(ctx, NK_KEY_SHIFT, down); break;
+        case SDLK_DELETE:    nk_input_key(ctx, NK_KEY_DEL, down); break;
+        case SDLK_RETURN:    nk_input_key(ctx, NK_KEY_ENTER, down); break;
+        case SDLK_TAB:       nk_input_key(ctx, NK_KEY_TAB, down); break;
+        case SDLK_BACKSPACE: nk_input_key(ctx, NK_KEY_BACKSPACE, down); break;
+        case SDLK_HOME:      nk_input_key(ctx, NK_KEY_TEXT_START, down);
+                             nk_input_key(ctx, NK_KEY_SCROLL_START, down); break;
+        case SDLK_END:       nk_input_key(ctx, NK_KEY_TEXT_END, down);
+                             nk_input_key(ctx, NK_KEY_SCROLL_END, down); break;
+        case SDLK_PAGEDOWN:  nk_input_key(ctx, NK_KEY_SCROLL_DOWN, down); break;
+        case SDLK_PAGEUP:    nk_input_key(ctx, NK_KEY_SCROLL_UP, down); break;
+        case SDLK_z:         nk_input_key(ctx, NK_KEY_TEXT_UNDO, down && state[SDL_SCANCODE_LCTRL]); break;
+        case SDLK_r:         nk_input_key(ctx, NK_KEY_TEXT_REDO, down && state[SDL_SCANCODE_LCTRL]); break;
+        case SDLK_c:         nk_input_key(ctx, NK_KEY_COPY, down && state[SDL_SCANCODE_LCTRL]); break;
+        case SDLK_v:         nk_input_key(ctx, NK_KEY_PASTE, down && state[SDL_SCANCODE_LCTRL]); break;
+        case SDLK_x:         nk_input_key(ctx, NK_KEY_CUT, down && state[SDL_SCANCODE_LCTRL]); break;
+        case SDLK_b:         nk_input_key(ctx, NK_KEY_TEXT_LINE_START, down && state[SDL_SCANCODE_LCTRL]); break;
+        case SDLK_e:         nk_input_key(ctx, NK_KEY_TEXT_LINE_END, down && state[SDL_SCANCODE_LCTRL]); break;
+        case SDLK_UP:        nk_input_key(ctx, NK_KEY_UP, down); break;
+        case SDLK_DOWN:      nk_input_key(ctx, NK_KEY_DOWN, down); break;
+        case SDLK_LEFT:
+            if (state[SDL_SCANCODE_LCTRL])
+                nk_input_key(ctx, NK_KEY_TEXT_WORD_LEFT, down);
+            else nk_input_key(ctx, NK_KEY_LEFT, down);
+            break;
+        case SDLK_RIGHT:
+            if (state[SDL_SCANCODE_LCTRL])
+                nk_input_key(ctx, NK_KEY_TEXT_WORD_RIGHT, down);
+            else nk_input_key(ctx, NK_KEY_RIGHT, down);
+            break;
+    }
+}
+
+NK_INTERN void
+nk_sdl_handle_button(struct nk_context *ctx, const SDL_MouseButtonEvent *button)
+{
+    int down = button->type == SDL_MOUSEBUTTONDOWN;
+    const int x = button->x, y = button->y;
+    switch(button->button)
+    {
+        case SDL_BUTTON_LEFT:
+            if (button->clicks > 1)
+                nk_input_button(ctx, NK_BUTTON_DOUBLE, x, y, down);
+            nk_input_button(ctx, NK_BUTTON_LEFT, x, y, down); break;
+        case SDL_BUTTON_MIDDLE: nk_input_button(ctx, NK_BUTTON_MIDDLE, x, y, down); break;
+        case SDL_BUTTON_RIGHT:  nk_input_button(ctx, NK_BUTTON_RIGHT, x, y, down); break;
+    }
+}
+
+/* an IME can commit several characters in one event, so all of them are fed */
+NK_INTERN void
+nk_sdl_handle_text(struct nk_context *ctx, const char *text)
+{
+    int len = nk_strlen(text);
+    while (len > 0) {
+        nk_rune unicode;
+        int glyph_len = nk_utf_decode(text, &unicode, len);
+        if (!glyph_len || unicode == NK_UTF_INVALID) break;
+        nk_input_unicode(ctx, unicode);
+        text += glyph_len;
+        len -= glyph_len;
+    }
+}
+
+NK_API int
+nk_sdl_handle_event(struct nk_sdl *sdl, SDL_Event *evt)
+{
+    struct nk_context *ctx = &sdl->ctx;
+
+    if (!nk_sdl_event_for_window(sdl, evt))
+        return 0;
+
+    /* optional grabbing behavior */
+    nk_sdl_update_grab(sdl);
 
     switch(evt->type)
     {
+        case SDL_WINDOWEVENT:
+            /* exposed/resized windows need a full redraw even when the UI
+             * itself did not change */
+            nk_sdl_invalidate(sdl);
+            return 0;
+
         case SDL_KEYUP: /* KEYUP & KEYDOWN share same routine */
         case SDL_KEYDOWN:
-            {
-                int down = evt->type == SDL_KEYDOWN;
-                const Uint8* state = SDL_GetKeyboardState(0);
-                switch(evt->key.keysym.sym)
-                {
-                    case SDLK_RSHIFT: /* RSHIFT & LSHIFT share same routine */
-                    case SDLK_LSHIFT:    nk_input_key(ctx, NK_KEY_SHIFT, down); break;
-                    case SDLK_DELETE:    nk_input_key(ctx, NK_KEY_DEL, down); break;
-                    case SDLK_RETURN:    nk_input_key(ctx, NK_KEY_ENTER, down); break;
-                    case SDLK_TAB:       nk_input_key(ctx, NK_KEY_TAB, down); break;
-                    case SDLK_BACKSPACE: nk_input_key(ctx, NK_KEY_BACKSPACE, down); break;
-                    case SDLK_HOME:      nk_input_key(ctx, NK_KEY_TEXT_START, down);
-                                         nk_input_key(ctx, NK_KEY_SCROLL_START, down); break;
-                    case SDLK_END:       nk_input_key(ctx, NK_KEY_TEXT_END, down);
-                                         nk_input_key(ctx, NK_KEY_SCROLL_END, down); break;
-                    case SDLK_PAGEDOWN:  nk_input_key(ctx, NK_KEY_SCROLL_DOWN, down); break;
-                    case SDLK_PAGEUP:    nk_input_key(ctx, NK_KEY_SCROLL_UP, down); break;
-                    case SDLK_z:         nk_input_key(ctx, NK_KEY_TEXT_UNDO, down && state[SDL_SCANCODE_LCTRL]); break;
-                    case SDLK_r:         nk_input_key(ctx, NK_KEY_TEXT_REDO, down && state[SDL_SCANCODE_LCTRL]); break;
-                    case SDLK_c:         nk_input_key(ctx, NK_KEY_COPY, down && state[SDL_SCANCODE_LCTRL]); break;
-                    case SDLK_v:         nk_input_key(ctx, NK_KEY_PASTE, down && state[SDL_SCANCODE_LCTRL]); break;
-                    case SDLK_x:         nk_input_key(ctx, NK_KEY_CUT, down && state[SDL_SCANCODE_LCTRL]); break;
-                    case SDLK_b:         nk_input_key(ctx, NK_KEY_TEXT_LINE_START, down && state[SDL_SCANCODE_LCTRL]); break;
-                    case SDLK_e:         nk_input_key(ctx, NK_KEY_TEXT_LINE_END, down && state[SDL_SCANCODE_LCTRL]); break;
-                    case SDLK_UP:        nk_input_key(ctx, NK_KEY_UP, down); break;
-                    case SDLK_DOWN:      nk_input_key(ctx, NK_KEY_DOWN, down); break;
-                    case SDLK_LEFT:
-                        if (state[SDL_SCANCODE_LCTRL])
-                            nk_input_key(ctx, NK_KEY_TEXT_WORD_LEFT, down);
-                        else nk_input_key(ctx, NK_KEY_LEFT, down);
-                        break;
-                    case SDLK_RIGHT:
-                        if (state[SDL_SCANCODE_LCTRL])
-                            nk_input_key(ctx, NK_KEY_TEXT_WORD_RIGHT, down);
-                        else nk_input_key(ctx, NK_KEY_RIGHT, down);
-                        break;
-                }
-            }
+            nk_sdl_handle_key(ctx, &evt->key, SDL_GetKeyboardState(0));
             return 1;
 
         case SDL_MOUSEBUTTONUP: /* MOUSEBUTTONUP & MOUSEBUTTONDOWN share same routine */
         case SDL_MOUSEBUTTONDOWN:
-            {
-                int down = evt->type == SDL_MOUSEBUTTONDOWN;
-                const int x = evt->button.x, y = evt->button.y;
-                switch(evt->button.button)
-                {
-                    case SDL_BUTTON_LEFT:
-                        if (evt->button.clicks > 1)
-                            nk_input_button(ctx, NK_BUTTON_DOUBLE, x, y, down);
-                        nk_input_button(ctx, NK_BUTTON_LEFT, x, y, down); break;
-                    case SDL_BUTTON_MIDDLE: nk_input_button(ctx, NK_BUTTON_MIDDLE, x, y, down); break;
-                    case SDL_BUTTON_RIGHT:  nk_input_button(ctx, NK_BUTTON_RIGHT, x, y, down); break;
-                }
-            }
+            nk_sdl_handle_button(ctx, &evt->button);
             return 1;
 
         case SDL_MOUSEMOTION:
@@ -350,11 +1563,7 @@ nk_sdl_handle_event(SDL_Event *evt)
             return 1;
 
         case SDL_TEXTINPUT:
-            {
-                nk_glyph glyph;
-                memcpy(glyph, evt->text.text, NK_UTF_SIZE);
-                nk_input_glyph(ctx, glyph);
-            }
+            NK_SDL_TEXT_INPUT(ctx, evt->text.text);
             return 1;
 
         case SDL_MOUSEWHEEL:
@@ -364,16 +1573,82 @@ nk_sdl_handle_event(SDL_Event *evt)
     return 0;
 }
 
+NK_API int
+nk_sdl_handle_events(struct nk_sdl *sdl, const SDL_Event *events, int count)
+{
+    struct nk_context *ctx = &sdl->ctx;
+    const Uint8 *state = SDL_GetKeyboardState(0);
+    nk_bool moved = nk_false;
+    int motion_x = 0, motion_y = 0, rel_x = 0, rel_y = 0;
+    float wheel_x = 0, wheel_y = 0;
+    int consumed = 0;
+    int i;
+
+    nk_sdl_update_grab(sdl);
+    for (i = 0; i < count; ++i) {
+        const SDL_Event *evt = &events[i];
+        if (!nk_sdl_event_for_window(sdl, evt))
+            continue;
+        switch(evt->type)
+        {
+            case SDL_WINDOWEVENT:
+                nk_sdl_invalidate(sdl);
+                continue;
+            case SDL_KEYUP:
+            case SDL_KEYDOWN:
+                nk_sdl_handle_key(ctx, &evt->key, state);
+                break;
+            case SDL_MOUSEBUTTONUP:
+            case SDL_MOUSEBUTTONDOWN:
+                nk_sdl_handle_button(ctx, &evt->button);
+                break;
+            case SDL_MOUSEMOTION:
+                /* Nuklear only looks at where the mouse ended up */
+                moved = nk_true;
+                motion_x = evt->motion.x;
+                motion_y = evt->motion.y;
+                rel_x += evt->motion.xrel;
+                rel_y += evt->motion.yrel;
+                break;
+            case SDL_TEXTINPUT:
+                NK_SDL_TEXT_INPUT(ctx, evt->text.text);
+                break;
+            case SDL_MOUSEWHEEL:
+                wheel_x += (float)evt->wheel.x;
+                wheel_y += (float)evt->wheel.y;
+                break;
+            default:
+                continue;
+        }
+        consumed++;
+    }
+
+    if (moved) {
+        if (ctx->input.mouse.grabbed) {
+            /* the frame may arrive in several batches; pos already holds the
+             * motion of the earlier ones, prev only that of the last frame */
+            int x = (int)ctx->input.mouse.pos.x, y = (int)ctx->input.mouse.pos.y;
+            nk_input_motion(ctx, x + rel_x, y + rel_y);
+        }
+        else nk_input_motion(ctx, motion_x, motion_y);
+    }
+    if (wheel_x != 0 || wheel_y != 0)
+        nk_input_scroll(ctx, nk_vec2(wheel_x, wheel_y));
+    return consumed;
+}
+
 NK_API
-void nk_sdl_shutdown(void)
+void nk_sdl_shutdown(struct nk_sdl *sdl)
 {
-    struct nk_sdl_device *dev = &sdl.ogl;
-    nk_font_atlas_clear(&sdl.atlas);
-    nk_free(&sdl.ctx);
-    SDL_DestroyTexture(dev->font_tex);
-    /* glDeleteTextures(1, &dev->font_tex); */
+    struct nk_sdl_device *dev = &sdl->ogl;
+    nk_free(&sdl->ctx);
+    nk_sdl_font_release(sdl->font);
     nk_buffer_free(&dev->cmds);
-    memset(&sdl, 0, sizeof(sdl));
+    nk_buffer_free(&dev->vbuf);
+    nk_buffer_free(&dev->ebuf);
+    nk_buffer_free(&dev->batches);
+    if (dev->target) SDL_DestroyTexture(dev->target);
+    memset(sdl, 0, sizeof(*sdl));
 }
 
 #endif /* NK_SDL_RENDERER_IMPLEMENTATION */
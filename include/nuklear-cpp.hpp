@@ -1,6 +1,23 @@
 #pragma once
 
-// nk_ptr, nk_sizeのデータサイズがvoid*以上になるようにする
-#define NK_INCLUDE_FIXED_TYPES
-
-#include "nuklear.h"
+#include "nuklear-cpp/config.hpp"
+#include "nuklear-cpp/allocator.hpp"
+#include "nuklear-cpp/atlas_cache.hpp"
+#include "nuklear-cpp/command_list.hpp"
+#include "nuklear-cpp/draw_data.hpp"
+#include "nuklear-cpp/frame_scheduler.hpp"
+#include "nuklear-cpp/glyph_atlas.hpp"
+#include "nuklear-cpp/headless.hpp"
+#include "nuklear-cpp/layout.hpp"
+#include "nuklear-cpp/list_view.hpp"
+#include "nuklear-cpp/parallel_convert.hpp"
+#include "nuklear-cpp/pipeline.hpp"
+#include "nuklear-cpp/profiler.hpp"
+#include "nuklear-cpp/scope.hpp"
+#include "nuklear-cpp/text_cache.hpp"
+#include "nuklear-cpp/text_input.hpp"
+#include "nuklear-cpp/theme.hpp"
+#include "nuklear-cpp/thread_pool.hpp"
+#include "nuklear-cpp/trace.hpp"
+#include "nuklear-cpp/vertex_kernels.hpp"
+#include "nuklear-cpp/vertex_layout.hpp"
@@ -0,0 +1,101 @@
+#pragma once
+
+#include <cstddef>
+#include <memory_resource>
+
+#include "nuklear-cpp/config.hpp"
+
+namespace nk {
+
+// std::pmr::memory_resourceをnk_allocatorとして使えるようにする
+// nk_allocatorのfreeにはサイズが渡されないので、確保した領域の直前にサイズを記録する
+// resourceはnk_allocatorを使う全てのオブジェクトより長く生存しなければならない
+nk_allocator make_allocator(std::pmr::memory_resource& resource) noexcept;
+
+// フレーム単位で使い捨てるモノトニックなアリーナ
+// deallocateは何もせず、reset()で全ての領域をまとめて解放する
+// 容量を超えた分はupstreamから確保し、次のreset()で最大使用量まで容量を広げる
+// スレッドセーフではない
+class frame_arena final : public std::pmr::memory_resource {
+public:
+    explicit frame_arena(
+        std::size_t capacity,
+        std::pmr::memory_resource* upstream = std::pmr::get_default_resource());
+    ~frame_arena() override;
+
+    frame_arena(const frame_arena&) = delete;
+    frame_arena& operator=(const frame_arena&) = delete;
+
+    // このフレームで確保した領域を全て無効にする
+    void reset() noexcept;
+
+    std::size_t capacity() const noexcept { return m_capacity; }
+    std::size_t used() const noexcept { return m_used + m_overflow_bytes; }
+    std::size_t high_water() const noexcept { return m_high_water; }
+    // 容量を超えてupstreamから確保した回数
+    std::size_t overflow_count() const noexcept { return m_overflow_count; }
+
+private:
+    struct overflow_block {
+        overflow_block* next;
+        std::size_t bytes;
+        std::size_t alignment;
+    };
+
+    void* do_allocate(std::size_t bytes, std::size_t alignment) override;
+    void do_deallocate(void* p, std::size_t bytes, std::size_t alignment) override;
+    bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override;
+
+    void release_overflow() noexcept;
+
+    std::pmr::memory_resource* m_upstream;
+    std::byte* m_buffer;
+    std::size_t m_capacity;
+    std::size_t m_used = 0;
+    overflow_block* m_overflow = nullptr;
+    std::size_t m_overflow_bytes = 0;
+    std::size_t m_overflow_count = 0;
+    std::size_t m_high_water = 0;
+};
+
+// 固定サイズのブロックを使い回すプール
+// block_sizeを超える要求はupstreamへそのまま渡す
+// スレッドセーフではない
+class block_pool final : public std::pmr::memory_resource {
+public:
+    block_pool(
+        std::size_t block_size, std::size_t blocks_per_chunk,
+        std::pmr::memory_resource* upstream = std::pmr::get_default_resource());
+    ~block_pool() override;
+
+    block_pool(const block_pool&) = delete;
+    block_pool& operator=(const block_pool&) = delete;
+
+    std::size_t block_size() const noexcept { return m_block_size; }
+    std::size_t blocks_in_use() const noexcept { return m_in_use; }
+    std::size_t blocks_reserved() const noexcept { return m_reserved; }
+
+private:
+    struct free_block {
+        free_block* next;
+    };
+    struct chunk {
+        chunk* next;
+    };
+
+    void* do_allocate(std::size_t bytes, std::size_t alignment) override;
+    void do_deallocate(void* p, std::size_t bytes, std::size_t alignment) override;
+    bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override;
+
+    void add_chunk();
+
+    std::pmr::memory_resource* m_upstream;
+    std::size_t m_block_size;
+    std::size_t m_blocks_per_chunk;
+    free_block* m_free = nullptr;
+    chunk* m_chunks = nullptr;
+    std::size_t m_in_use = 0;
+    std::size_t m_reserved = 0;
+};
+
+} // namespace nk
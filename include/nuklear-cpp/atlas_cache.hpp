@@ -0,0 +1,45 @@
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+
+#include "nuklear-cpp/config.hpp"
+
+namespace nk {
+
+// ベイク済みのフォントアトラスのディスクキャッシュ
+// RGBA32の画像とグリフの表、カーソルの位置をディレクトリ内のファイルに保存し、
+// 次回からはファイルをメモリマップしてnk_font_atlas_bake(stb_truetypeによるラスタライズ)を省く
+// ファイル名はフォントのデータ、サイズ、文字の範囲、オーバーサンプリング等から求めたキーで決まる
+// ファイルは作ったマシンでだけ読めればよいので、バイト順は考慮しない
+class atlas_cache {
+public:
+    explicit atlas_cache(std::filesystem::path directory);
+    ~atlas_cache();
+
+    atlas_cache(const atlas_cache&) = delete;
+    atlas_cache& operator=(const atlas_cache&) = delete;
+
+    // nk_font_atlas_bake(atlas, width, height, NK_FONT_ATLAS_RGBA32)の代わりに呼ぶ
+    // nk_font_atlas_beginとフォントの追加が済んだatlasを受け取り、キャッシュがあれば読み込む
+    // なければベイクしてキャッシュに書き込む。書き込みに失敗してもベイクの結果は返す
+    // 戻り値の画像は次のbakeかこのオブジェクトの破棄まで有効。その後はnk_font_atlas_endを呼ぶ
+    const void* bake(nk_font_atlas* atlas, int* width, int* height);
+
+    // atlasのフォントとベイクの設定から決まるキー
+    static std::uint64_t key(const nk_font_atlas& atlas) noexcept;
+    std::filesystem::path path(std::uint64_t key) const;
+
+    // 直前のbakeがキャッシュから読み込んだかどうか
+    bool loaded() const noexcept { return m_loaded; }
+
+private:
+    struct mapping;
+
+    std::filesystem::path m_directory;
+    std::unique_ptr<mapping> m_mapping;
+    bool m_loaded = false;
+};
+
+} // namespace nk
@@ -0,0 +1,76 @@
+#pragma once
+
+#include <cstddef>
+#include <iterator>
+#include <vector>
+
+#include "nuklear-cpp/config.hpp"
+
+namespace nk {
+
+// コマンドが実際に使っているバイト数
+// 可変長のコマンド(多角形・文字列)は最後の要素までを数える
+std::size_t command_size(const nk_command* cmd) noexcept;
+
+// 1フレーム分のコマンドキューのコピー
+// コンテキストから切り離されているので、nk_clearの後や別スレッドでも変換できる
+// テキストのフォントやカスタムコマンドのコールバックはポインタのまま保持するので、
+// それらは変換が終わるまで生存していなければならない
+class command_list {
+public:
+    class iterator {
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = const nk_command*;
+        using difference_type = std::ptrdiff_t;
+        using pointer = void;
+        using reference = const nk_command*;
+
+        iterator() = default;
+        iterator(const std::byte* memory, const std::size_t* offset) noexcept
+            : m_memory(memory), m_offset(offset) {}
+
+        const nk_command* operator*() const noexcept {
+            return reinterpret_cast<const nk_command*>(m_memory + *m_offset);
+        }
+        iterator& operator++() noexcept {
+            ++m_offset;
+            return *this;
+        }
+        iterator operator++(int) noexcept {
+            iterator tmp = *this;
+            ++m_offset;
+            return tmp;
+        }
+        bool operator==(const iterator& other) const noexcept { return m_offset == other.m_offset; }
+
+    private:
+        const std::byte* m_memory = nullptr;
+        const std::size_t* m_offset = nullptr;
+    };
+
+    // ctxのコマンドキューをnk_foreachの順にコピーする。以前の内容は破棄する
+    // nk_foreachと同じくnk_buildが走るので、ctxの描画順はこの時点で確定する
+    void capture(nk_context* ctx);
+    void clear() noexcept;
+    // cmdのコピーを末尾に追加する
+    void append(const nk_command* cmd);
+
+    iterator begin() const noexcept { return {m_memory.data(), m_offsets.data()}; }
+    iterator end() const noexcept { return {m_memory.data(), m_offsets.data() + m_offsets.size()}; }
+    std::size_t size() const noexcept { return m_offsets.size(); }
+    bool empty() const noexcept { return m_offsets.empty(); }
+    std::size_t size_bytes() const noexcept { return m_memory.size(); }
+    const nk_command* operator[](std::size_t i) const noexcept {
+        return reinterpret_cast<const nk_command*>(m_memory.data() + m_offsets[i]);
+    }
+
+private:
+    // operator newが返す領域の境界に合わせて全てのコマンド型を置けるようにする
+    static constexpr std::size_t alignment = alignof(std::max_align_t);
+
+    std::vector<std::byte> m_memory;
+    std::vector<std::size_t> m_offsets;
+};
+
+} // namespace nk
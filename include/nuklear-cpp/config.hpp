@@ -0,0 +1,14 @@
+#pragma once
+
+// ライブラリと利用側で構造体のレイアウトが変わらないよう、Nuklearの設定はここでのみ行う
+
+// nk_ptr, nk_sizeのデータサイズがvoid*以上になるようにする
+#define NK_INCLUDE_FIXED_TYPES
+#define NK_INCLUDE_STANDARD_IO
+#define NK_INCLUDE_STANDARD_VARARGS
+#define NK_INCLUDE_DEFAULT_ALLOCATOR
+#define NK_INCLUDE_VERTEX_BUFFER_OUTPUT
+#define NK_INCLUDE_FONT_BAKING
+#define NK_INCLUDE_DEFAULT_FONT
+
+#include "nuklear.h"
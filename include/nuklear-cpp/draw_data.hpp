@@ -0,0 +1,153 @@
+#pragma once
+
+#include <cstddef>
+#include <cstring>
+#include <type_traits>
+#include <vector>
+
+#include "nuklear-cpp/config.hpp"
+#include "nuklear-cpp/text_cache.hpp"
+#include "nuklear-cpp/vertex_layout.hpp"
+
+namespace nk {
+
+// nk_convertの結果をバックエンドがそのまま使える形で保持する
+// indicesはcommandsの順にelem_count個ずつ並ぶ
+// 頂点の型はvertex_format<Vertex>の特殊化で形式を決めたものなら何でもよい
+template <class Vertex>
+struct basic_draw_data {
+    using layout = vertex_layout<Vertex>;
+    static_assert(layout::size == sizeof(Vertex));
+
+    std::vector<Vertex> vertices;
+    std::vector<nk_draw_index> indices;
+    std::vector<nk_draw_command> commands;
+
+    void clear() noexcept {
+        vertices.clear();
+        indices.clear();
+        commands.clear();
+    }
+};
+
+using draw_data = basic_draw_data<vertex>;
+
+// nk_convert_configのうち頂点レイアウト以外の設定
+struct convert_options {
+    nk_draw_null_texture tex_null{};
+    nk_anti_aliasing anti_aliasing = NK_ANTI_ALIASING_ON;
+    unsigned int circle_segments = 22;
+    unsigned int curve_segments = 22;
+    unsigned int arc_segments = 22;
+    float global_alpha = 1.0f;
+    // 正なら円・円弧・曲線・角丸の分割数を、画面上の誤差がこのピクセル数以下になる最小の数にする
+    // その場合の*_segmentsは分割数の上限になる。0なら常に*_segmentsで分割する
+    float segment_tolerance = 0.0f;
+    // テキストの頂点を文字列ごとにconverterのtext_cacheへ覚えて使い回す
+    bool cache_text = true;
+};
+
+class command_list;
+
+// convert_optionsとvertexのレイアウトからnk_convert_configを作る
+nk_convert_config make_convert_config(const convert_options& options) noexcept;
+
+// configの頂点レイアウトがvertexと同じならtrue
+// 同じなら線と多角形はstroke_path/fill_path(vertex_kernels.hpp)で直接書き込む
+bool matches_vertex_layout(const nk_convert_config& config) noexcept;
+
+// 1つのコマンドをnk_convertと同じ方法でlistに展開する
+// segment_toleranceはconvert_options::segment_toleranceと同じ。頂点レイアウトがvertexの時だけ効く
+// textsがあればテキストの頂点をそこに覚えて使い回す
+void tessellate(nk_draw_list& list, const nk_command* cmd, const nk_convert_config& config,
+                float segment_tolerance = 0.0f, text_cache* texts = nullptr);
+
+// nk_convertと同じ引数と戻り値で、コンテキストのコマンドキューを変換する
+// 頂点レイアウトがvertexと同じならtessellateと同じく専用の経路を使う
+// textsのnext_frameは呼ばない。1フレームに何度変換しても、呼び出し側がフレームごとに1回呼ぶ
+nk_flags convert(nk_context* ctx, nk_buffer* cmds, nk_buffer* vertices, nk_buffer* elements,
+                 const nk_convert_config* config, float segment_tolerance = 0.0f,
+                 text_cache* texts = nullptr);
+
+// コンテキストのコマンドキューをdraw_dataへ変換する
+// nk_convertに渡す作業用バッファはフレームをまたいで使い回す
+// コマンドキュー全体の変換を1フレームとして、テキストのキャッシュのnext_frameを呼ぶ
+class converter {
+public:
+    // allocatorがnullptrならデフォルトのアロケータを使う
+    explicit converter(const nk_allocator* allocator = nullptr);
+    ~converter();
+
+    converter(const converter&) = delete;
+    converter& operator=(const converter&) = delete;
+
+    // nk_convertの戻り値(NK_CONVERT_*)を返す
+    // 頂点はvertexとして書き込んだ後、Vertexが別の型ならvertex_layout<Vertex>::packで詰め直す
+    // カーネルはNK_IMPLEMENTATIONの翻訳単位にあって利用側の型では実体化できないので、
+    // vertexと違うレイアウトでは頂点ごとの詰め直しが1回加わる。同じレイアウトなら加わらない
+    template <class Vertex>
+    nk_flags convert(nk_context* ctx, const convert_options& options, basic_draw_data<Vertex>& out) {
+        const nk_flags result = fill_buffers(ctx, options);
+        copy_output(out);
+        return result;
+    }
+    // コピーしたコマンドキューを変換する。コンテキストに触れないので別スレッドで使える
+    template <class Vertex>
+    nk_flags convert(const command_list& commands, const convert_options& options, basic_draw_data<Vertex>& out) {
+        const nk_flags result = fill_buffers(commands, options);
+        copy_output(out);
+        return result;
+    }
+    // commandsの[first, last)番目のコマンドだけを変換する
+    // 1フレームを区間に分けて変換するためのもので、texts().next_frame()は呼び出し側が呼ぶ
+    template <class Vertex>
+    nk_flags convert(const command_list& commands, std::size_t first, std::size_t last,
+                     const convert_options& options, basic_draw_data<Vertex>& out) {
+        const nk_flags result = fill_buffers(commands, first, last, options);
+        copy_output(out);
+        return result;
+    }
+
+    // テキストの頂点のキャッシュ。フォントのアトラスを作り直した時はclearする
+    text_cache& texts() noexcept { return m_texts; }
+
+private:
+    void clear_buffers() noexcept;
+    // 変換結果をm_vertices/m_elementsに、描画コマンドをm_outputから辿れるように残す
+    nk_flags fill_buffers(nk_context* ctx, const convert_options& options);
+    nk_flags fill_buffers(const command_list& commands, const convert_options& options);
+    nk_flags fill_buffers(const command_list& commands, std::size_t first, std::size_t last,
+                          const convert_options& options);
+    void copy_elements(std::vector<nk_draw_index>& indices, std::vector<nk_draw_command>& commands) const;
+
+    std::size_t vertex_count() const noexcept { return m_vertices.allocated / sizeof(vertex); }
+    const vertex* vertices() const noexcept { return static_cast<const vertex*>(nk_buffer_memory_const(&m_vertices)); }
+
+    template <class Vertex>
+    void copy_output(basic_draw_data<Vertex>& out) {
+        const vertex* first = vertices();
+        const std::size_t count = vertex_count();
+        if constexpr (std::is_same_v<Vertex, vertex>) {
+            out.vertices.assign(first, first + count);
+        } else if constexpr (vertex_layout<Vertex>::matches_vertex) {
+            out.vertices.resize(count);
+            std::memcpy(out.vertices.data(), first, count * sizeof(vertex));
+        } else {
+            out.vertices.resize(count);
+            for (std::size_t i = 0; i < count; ++i) {
+                vertex_layout<Vertex>::pack(first[i], out.vertices[i]);
+            }
+        }
+        copy_elements(out.indices, out.commands);
+    }
+
+    nk_buffer m_commands;
+    nk_buffer m_vertices;
+    nk_buffer m_elements;
+    text_cache m_texts;
+    // command_listを変換する時の描画リスト
+    nk_draw_list m_list;
+    const nk_draw_list* m_output = nullptr;
+};
+
+} // namespace nk
@@ -0,0 +1,72 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+
+#include "nuklear-cpp/config.hpp"
+
+namespace nk {
+
+// イベントの待ち方と起こし方。プラットフォームごとに用意する
+struct frame_waiter {
+    void* userdata = nullptr;
+    // 入力などのイベントが来るかtimeout_msミリ秒経つまで待つ。timeout_msが負なら無期限
+    // イベントが来ていればtrue。イベントはキューから取り出さずに残す(SDL_WaitEventTimeout(NULL, ...))
+    bool (*wait)(void* userdata, int timeout_ms) = nullptr;
+    // 他のスレッドからwaitを起こす(SDL_PushEvent等)。どのスレッドから呼ばれてもよい
+    void (*wake)(void* userdata) = nullptr;
+};
+
+// 必要な時だけフレームを回すためのスケジューラ
+// 入力がなく、ボタンも押されておらず、アプリケーションから頼まれてもいなければwaitで眠る
+// 入力の後もNuklearの状態が落ち着くまで(ポップアップの開閉やフォーカスの移動は1フレーム遅れて
+// 反映される)settle_framesだけ続けて回す
+//
+// 使い方:
+//     scheduler.wait();            // 入力を読む前
+//     ... nk_input_begin〜nk_input_end、UIを組み立てる ...
+//     scheduler.frame_done(ctx);   // nk_clear(nk_sdl_render等)より前
+class frame_scheduler {
+public:
+    explicit frame_scheduler(const frame_waiter& waiter, int settle_frames = 2);
+
+    frame_scheduler(const frame_scheduler&) = delete;
+    frame_scheduler& operator=(const frame_scheduler&) = delete;
+
+    // 次のフレームを回すべき時まで待つ
+    void wait();
+    // 組み立てたフレームの状態を見て、続けてフレームが要るかを決める
+    // マウスのボタンが押されている間(ドラッグ、押し続けると繰り返すボタン)は止めない
+    void frame_done(const nk_context* ctx);
+
+    // データが変わったので次のフレームを回す。どのスレッドから呼んでもよい
+    void request_frame();
+    // delay後にフレームを回す。時計やアニメーションのように時間で変わる表示に使う
+    // 複数頼まれたら最も早いものから回す。どのスレッドから呼んでもよい
+    void request_frame_in(std::chrono::milliseconds delay);
+
+    void set_settle_frames(int frames) noexcept { m_settle_frames = frames; }
+
+    // 回したフレームと、眠った回数
+    std::uint64_t frames() const noexcept { return m_frames; }
+    std::uint64_t sleeps() const noexcept { return m_sleeps; }
+
+private:
+    using clock = std::chrono::steady_clock;
+
+    frame_waiter m_waiter;
+    int m_settle_frames;
+    // 待たずに回すフレームの数
+    int m_pending = 1;
+    // 以下はどのスレッドからも触るのでm_mutexで守る
+    std::mutex m_mutex;
+    bool m_requested = false;
+    // waitの中で眠っている。起こす必要があるのはこの間だけ
+    bool m_sleeping = false;
+    clock::time_point m_deadline = clock::time_point::max();
+    std::uint64_t m_frames = 0;
+    std::uint64_t m_sleeps = 0;
+};
+
+} // namespace nk
@@ -0,0 +1,96 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "nuklear-cpp/config.hpp"
+
+namespace nk {
+
+// 使われた時にグリフをラスタライズして詰めていくフォントアトラス
+// 起動時に文字の範囲を全てベイクする代わりに、nk_user_fontのquery/widthで初めて出てきた文字だけを
+// stb_truetypeで描いて空き領域に置く。日本語のように文字数の多いフォントの起動時間とメモリを抑える
+//
+// 画素はRGBA32(白にアルファ)。書き換えた範囲はdirty_rectにまとめられるので、
+// 描画の前にその部分だけをテクスチャへ転送してclear_dirtyを呼ぶ
+// 空きがない時はそのグリフを空白にしてnext_frameで古い行を捨てる(行単位のLRU)
+// 捨てたグリフのUVは無効になるので、next_frameがtrueを返したらtext_cacheをclearし、描画し直す
+// スレッドセーフではない。parallel_converterやconvert_pipelineからは使わない
+class glyph_atlas {
+public:
+    explicit glyph_atlas(int width = 1024, int height = 1024);
+    ~glyph_atlas();
+
+    glyph_atlas(const glyph_atlas&) = delete;
+    glyph_atlas& operator=(const glyph_atlas&) = delete;
+
+    // TTFのデータ(コピーして持つ)からpixel_heightの高さのフォントを作る。読めなければnullptr
+    // 返したフォントはこのオブジェクトと同じだけ生存する
+    nk_user_font* add_font(const void* ttf, std::size_t size, float pixel_height);
+    // nk_font_atlas_add_defaultと同じProggyClean
+    nk_user_font* add_default_font(float pixel_height);
+
+    // フォントが描画に使うテクスチャ
+    void set_texture(nk_handle texture) noexcept;
+    // 白く塗られた画素のUV。nk_draw_null_textureに使う
+    nk_vec2 white_uv() const noexcept;
+
+    int width() const noexcept { return m_width; }
+    int height() const noexcept { return m_height; }
+    const std::uint32_t* pixels() const noexcept { return m_pixels.data(); }
+    // 1行のバイト数
+    int pitch() const noexcept { return m_width * 4; }
+
+    // 前回のclear_dirtyから後に書き換えた範囲。wが0なら変更なし
+    nk_recti dirty_rect() const noexcept { return m_dirty; }
+    const std::uint32_t* dirty_pixels() const noexcept;
+    void clear_dirty() noexcept { m_dirty = nk_recti{0, 0, 0, 0}; }
+
+    // フレームの区切り。空きが足りなかったら古い行を捨て、捨てたらtrue
+    bool next_frame();
+    // このフレームに入らず空白で描いたグリフがある。描画の後に見て、trueなら入力がなくても
+    // 次のフレームを回す(frame_scheduler::request_frame)。そのnext_frameで行を空けて描き直す
+    bool missed() const noexcept { return m_missed_height > 0; }
+
+    std::size_t glyph_count() const noexcept { return m_glyph_count; }
+    std::size_t evictions() const noexcept { return m_evictions; }
+
+private:
+    struct face;
+    struct glyph;
+
+    // 詰める行。高さはその行を最初に使ったグリフで決まる
+    struct shelf {
+        int y;
+        int height;
+        int x = 0;
+        std::uint64_t last_used = 0;
+        std::vector<glyph*> glyphs;
+    };
+
+    static float text_width(nk_handle handle, float height, const char* text, int len);
+    static void query(nk_handle handle, float height, struct nk_user_font_glyph* out, nk_rune codepoint,
+                      nk_rune next_codepoint);
+
+    glyph& find(face& f, nk_rune codepoint);
+    bool rasterize(face& f, glyph& g);
+    shelf* allocate(int w, int h);
+    void mark_dirty(int x, int y, int w, int h) noexcept;
+
+    int m_width;
+    int m_height;
+    std::vector<std::uint32_t> m_pixels;
+    std::vector<std::unique_ptr<face>> m_faces;
+    std::vector<shelf> m_shelves;
+    nk_recti m_dirty;
+    nk_handle m_texture{};
+    std::uint64_t m_frame = 1;
+    // このフレームに入らなかったグリフの高さの最大値
+    int m_missed_height = 0;
+    std::size_t m_glyph_count = 0;
+    std::size_t m_evictions = 0;
+};
+
+} // namespace nk
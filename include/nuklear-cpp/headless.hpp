@@ -0,0 +1,97 @@
+#pragma once
+
+#include <cstdint>
+#include <span>
+#include <vector>
+
+#include "nuklear-cpp/config.hpp"
+#include "nuklear-cpp/draw_data.hpp"
+#include "nuklear-cpp/profiler.hpp"
+
+namespace nk {
+
+// RGBA8の画像
+// 各画素はメモリ上でR,G,B,Aの順に並ぶ(nk_font_atlas_bakeのNK_FONT_ATLAS_RGBA32と同じ)
+// nk_handle.ptrにtextureへのポインタを入れるとsoftware_rasterizerから参照できる
+class texture {
+public:
+    texture() = default;
+    texture(int width, int height);
+    texture(int width, int height, const void* rgba);
+
+    int width() const noexcept { return m_width; }
+    int height() const noexcept { return m_height; }
+    std::span<std::uint32_t> pixels() noexcept { return m_pixels; }
+    std::span<const std::uint32_t> pixels() const noexcept { return m_pixels; }
+    std::uint32_t at(int x, int y) const noexcept { return m_pixels[y * m_width + x]; }
+    nk_color color_at(int x, int y) const noexcept;
+
+    void clear(nk_color color) noexcept;
+
+    // 許容誤差toleranceを超えるチャンネルを持つ画素の数を返す
+    // サイズが異なる場合は全画素が異なるものとする
+    std::size_t diff(const texture& other, int tolerance = 0) const noexcept;
+
+    // バイナリPPM(P6)として保存する。アルファは捨てる
+    bool write_ppm(const char* path) const;
+
+private:
+    int m_width = 0;
+    int m_height = 0;
+    std::vector<std::uint32_t> m_pixels;
+};
+
+using framebuffer = texture;
+
+// draw_dataをCPUで三角形ラスタライズする
+// コマンドのtexture.ptrがnullptrなら白いテクスチャとして扱う
+void rasterize(const draw_data& data, framebuffer& target);
+
+// ウィンドウを持たずにNuklearのフレームを回すためのコンテキスト
+// デフォルトフォントのアトラス、変換用バッファ、フレームバッファを所有する
+// 1フレームは input_begin() → 入力 → input_end() → UI構築 → render() の順に進める
+class headless_context {
+public:
+    // allocatorがnullptrならデフォルトのアロケータを使う
+    headless_context(int width, int height, float font_height = 13.0f,
+                     const nk_allocator* allocator = nullptr);
+    ~headless_context();
+
+    headless_context(const headless_context&) = delete;
+    headless_context& operator=(const headless_context&) = delete;
+
+    nk_context* context() noexcept { return &m_ctx; }
+    const nk_user_font* font() const noexcept { return m_font; }
+    framebuffer& target() noexcept { return m_target; }
+    const framebuffer& target() const noexcept { return m_target; }
+    const draw_data& last_draw_data() const noexcept { return m_data; }
+    convert_options& options() noexcept { return m_options; }
+
+    void set_clear_color(nk_color color) noexcept { m_clear_color = color; }
+    // 設定するとinput_begin()からsubmit()までを1フレームとして記録する
+    void set_profiler(profiler* p) noexcept { m_profiler = p; }
+
+    void input_begin();
+    void input_end();
+
+    // コマンドキューを頂点列に変換する。nk_convertの戻り値を返す
+    nk_flags convert();
+    // 直前のconvert()の結果をフレームバッファに描画し、コマンドキューを破棄する
+    void submit();
+    // convert()とsubmit()をまとめて行う
+    void render();
+
+private:
+    nk_context m_ctx;
+    nk_font_atlas m_atlas;
+    const nk_user_font* m_font = nullptr;
+    texture m_font_texture;
+    converter m_converter;
+    convert_options m_options;
+    draw_data m_data;
+    framebuffer m_target;
+    nk_color m_clear_color{30, 30, 30, 255};
+    profiler* m_profiler = nullptr;
+};
+
+} // namespace nk
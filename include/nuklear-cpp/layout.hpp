@@ -0,0 +1,81 @@
+#pragma once
+
+#include <cstddef>
+
+#include "nuklear-cpp/config.hpp"
+
+namespace nk {
+
+// 行の高さを揃えて、横幅をウィンドウに合わせて等分する
+inline void row_dynamic(nk_context* ctx, float height, int cols) noexcept {
+    nk_layout_row_dynamic(ctx, height, cols);
+}
+
+// 行の高さと要素の幅を固定する
+inline void row_static(nk_context* ctx, float height, int item_width, int cols) noexcept {
+    nk_layout_row_static(ctx, height, item_width, cols);
+}
+
+// 列ごとの比率(NK_DYNAMIC)または幅(NK_STATIC)を配列で与える
+// 列数は配列の長さから決まるので、数え間違いが起きない
+template <std::size_t N>
+inline void row(nk_context* ctx, nk_layout_format format, float height, const float (&widths)[N]) noexcept {
+    static_assert(N > 0, "row needs at least one column");
+    nk_layout_row(ctx, format, height, static_cast<int>(N), widths);
+}
+
+// nk_layout_row_begin/push/endの組
+class row_builder {
+public:
+    row_builder(nk_context* ctx, nk_layout_format format, float height, int cols) noexcept : m_ctx(ctx) {
+        nk_layout_row_begin(ctx, format, height, cols);
+    }
+    ~row_builder() { nk_layout_row_end(m_ctx); }
+
+    row_builder(const row_builder&) = delete;
+    row_builder& operator=(const row_builder&) = delete;
+
+    void push(float value) noexcept { nk_layout_row_push(m_ctx, value); }
+
+private:
+    nk_context* m_ctx;
+};
+
+// nk_layout_row_template_begin/push_*/endの組
+class row_template {
+public:
+    row_template(nk_context* ctx, float height) noexcept : m_ctx(ctx) {
+        nk_layout_row_template_begin(ctx, height);
+    }
+    ~row_template() { nk_layout_row_template_end(m_ctx); }
+
+    row_template(const row_template&) = delete;
+    row_template& operator=(const row_template&) = delete;
+
+    void push_dynamic() noexcept { nk_layout_row_template_push_dynamic(m_ctx); }
+    void push_variable(float min_width) noexcept { nk_layout_row_template_push_variable(m_ctx, min_width); }
+    void push_static(float width) noexcept { nk_layout_row_template_push_static(m_ctx, width); }
+
+private:
+    nk_context* m_ctx;
+};
+
+// nk_layout_space_begin/push/endの組
+class space {
+public:
+    space(nk_context* ctx, nk_layout_format format, float height, int widget_count) noexcept : m_ctx(ctx) {
+        nk_layout_space_begin(ctx, format, height, widget_count);
+    }
+    ~space() { nk_layout_space_end(m_ctx); }
+
+    space(const space&) = delete;
+    space& operator=(const space&) = delete;
+
+    void push(struct nk_rect bounds) noexcept { nk_layout_space_push(m_ctx, bounds); }
+    struct nk_rect bounds() const noexcept { return nk_layout_space_bounds(m_ctx); }
+
+private:
+    nk_context* m_ctx;
+};
+
+} // namespace nk
@@ -0,0 +1,154 @@
+#pragma once
+
+#include <cstddef>
+#include <span>
+#include <vector>
+
+#include "nuklear-cpp/config.hpp"
+#include "nuklear-cpp/scope.hpp"
+
+namespace nk {
+
+// 仮想化したリストのスクロール位置。フレームをまたいで呼び出し側が持つ
+struct list_view_state {
+    nk_uint x_offset = 0;
+    nk_uint y_offset = 0;
+};
+
+// 見えている行の範囲[begin, end)
+struct visible_rows {
+    std::size_t begin = 0;
+    std::size_t end = 0;
+};
+
+// 行ごとに高さが違うリストの、各行の上端の位置
+// 行間(style.window.spacing.y)は含まず、位置を求める時に足す
+class row_heights {
+public:
+    row_heights() = default;
+
+    // height(row)で全行の高さを求め直す
+    template <class Height>
+    void assign(std::size_t count, Height&& height) {
+        m_tops.resize(count + 1);
+        for (std::size_t i = 0; i < count; ++i) {
+            m_tops[i + 1] = m_tops[i] + static_cast<double>(height(i));
+        }
+    }
+    // 末尾に行を足す。ログのように増えていくリスト向け
+    void push_back(float height) { m_tops.push_back(m_tops.back() + static_cast<double>(height)); }
+    // 1行の高さを変える。後ろの行の位置を全て直すので、行数に比例する
+    void set(std::size_t row, float height) noexcept;
+    void clear() noexcept { m_tops.assign(1, 0.0); }
+
+    std::size_t size() const noexcept { return m_tops.size() - 1; }
+    float height(std::size_t row) const noexcept { return static_cast<float>(m_tops[row + 1] - m_tops[row]); }
+    // 行の上端。rowがsize()なら全体の高さ
+    double top(std::size_t row, float spacing) const noexcept {
+        return m_tops[row] + static_cast<double>(row) * spacing;
+    }
+    // [offset, offset + view_height)に掛かる行。二分探索で求める
+    visible_rows visible(double offset, double view_height, float spacing) const noexcept;
+
+private:
+    std::vector<double> m_tops{0.0};
+};
+
+namespace detail {
+
+// 高さrow_heightの行がcount行並ぶ時、[offset, offset + view_height)に掛かる行
+visible_rows fixed_rows(std::size_t count, float row_height, float spacing, double offset,
+                        double view_height) noexcept;
+
+// 行間を含めてheightだけ下へ進める。見えない行の代わりに置く
+void vertical_space(nk_context* ctx, double height) noexcept;
+
+// スクロールするグループの中で、見えている行だけをbuildで作り、残りは空白で埋める
+// range(view_height)が行の範囲を、top(row)が行の上端を、layout(row)がその行のレイアウトを決める
+template <class Range, class Top, class Layout, class Build>
+visible_rows virtual_rows(nk_context* ctx, list_view_state& state, const char* title, nk_flags flags,
+                          std::size_t row_count, Range&& range, Top&& top, Layout&& layout, Build&& build) {
+    const auto body = group_scrolled(ctx, state.x_offset, state.y_offset, title, flags);
+    if (!body) {
+        return {};
+    }
+    // nk_window_get_content_regionは親のクリップ矩形で切った高さなので、グループが親から
+    // はみ出していると見える行を少なく見積もる。切られる前のグループの中身の高さを使う
+    const visible_rows rows = range(static_cast<double>(ctx->current->layout->bounds.h));
+    vertical_space(ctx, top(rows.begin));
+    for (std::size_t row = rows.begin; row < rows.end; ++row) {
+        layout(row);
+        build(row);
+    }
+    vertical_space(ctx, top(row_count) - top(rows.end));
+    return rows;
+}
+
+} // namespace detail
+
+// 高さの揃ったrow_count行のリスト。nk_list_viewと違い、行数に比例する処理をしない
+// 見えている行についてだけ、1列の行(nk_layout_row_dynamic)を始めてからbuild(row)を呼ぶ
+// buildは同じ高さの1行だけを作る。列を分けたければ同じ高さで別のレイアウトを始めてよい
+// 戻り値は作った行の範囲
+template <class Build>
+visible_rows list_view(nk_context* ctx, list_view_state& state, const char* title, nk_flags flags,
+                       std::size_t row_count, float row_height, Build&& build) {
+    const float spacing = ctx->style.window.spacing.y;
+    return detail::virtual_rows(
+        ctx, state, title, flags, row_count,
+        [&](double view_height) {
+            return detail::fixed_rows(row_count, row_height, spacing, state.y_offset, view_height);
+        },
+        [&](std::size_t row) { return static_cast<double>(row) * (row_height + spacing); },
+        [&](std::size_t) { nk_layout_row_dynamic(ctx, row_height, 1); }, build);
+}
+
+// 行ごとに高さの違うリスト。rowsの行数と高さを使う
+template <class Build>
+visible_rows list_view(nk_context* ctx, list_view_state& state, const char* title, nk_flags flags,
+                       const row_heights& rows, Build&& build) {
+    const float spacing = ctx->style.window.spacing.y;
+    return detail::virtual_rows(
+        ctx, state, title, flags, rows.size(),
+        [&](double view_height) { return rows.visible(state.y_offset, view_height, spacing); },
+        [&](std::size_t row) { return rows.top(row, spacing); },
+        [&](std::size_t row) { nk_layout_row_dynamic(ctx, rows.height(row), 1); }, build);
+}
+
+// 列の比率(NK_DYNAMIC)または幅(NK_STATIC)をcolumnsで与える表
+// 見えている行についてだけnk_layout_rowで列を切ってからbuild(row)を呼ぶ。buildは列の数だけ部品を作る
+// columnsはこの呼び出しの間有効でなければならない
+template <class Build>
+visible_rows table_view(nk_context* ctx, list_view_state& state, const char* title, nk_flags flags,
+                        nk_layout_format format, std::span<const float> columns, std::size_t row_count,
+                        float row_height, Build&& build) {
+    const float spacing = ctx->style.window.spacing.y;
+    return detail::virtual_rows(
+        ctx, state, title, flags, row_count,
+        [&](double view_height) {
+            return detail::fixed_rows(row_count, row_height, spacing, state.y_offset, view_height);
+        },
+        [&](std::size_t row) { return static_cast<double>(row) * (row_height + spacing); },
+        [&](std::size_t) {
+            nk_layout_row(ctx, format, row_height, static_cast<int>(columns.size()), columns.data());
+        },
+        build);
+}
+
+// 行ごとに高さの違う表
+template <class Build>
+visible_rows table_view(nk_context* ctx, list_view_state& state, const char* title, nk_flags flags,
+                        nk_layout_format format, std::span<const float> columns, const row_heights& rows,
+                        Build&& build) {
+    const float spacing = ctx->style.window.spacing.y;
+    return detail::virtual_rows(
+        ctx, state, title, flags, rows.size(),
+        [&](double view_height) { return rows.visible(state.y_offset, view_height, spacing); },
+        [&](std::size_t row) { return rows.top(row, spacing); },
+        [&](std::size_t row) {
+            nk_layout_row(ctx, format, rows.height(row), static_cast<int>(columns.size()), columns.data());
+        },
+        build);
+}
+
+} // namespace nk
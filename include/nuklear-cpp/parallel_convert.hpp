@@ -0,0 +1,58 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+#include "nuklear-cpp/command_list.hpp"
+#include "nuklear-cpp/config.hpp"
+#include "nuklear-cpp/draw_data.hpp"
+#include "nuklear-cpp/thread_pool.hpp"
+
+namespace nk {
+
+// コマンドキューを複数のスレッドで変換する
+// ウィンドウやパネルの描画はクリップ矩形の設定(NK_COMMAND_SCISSOR)から始まり、
+// それ以前のコマンドに依存しないので、そこで区切った区間ごとに独立して変換できる
+// 区間ごとの頂点・インデックスは最後に順番通りつなぎ、インデックスを付け替える
+// 結果はconverter::convertと同じ描画になる
+// フォントのquery/widthやカスタムコマンドのコールバックは複数のスレッドから同時に呼ばれる
+// nk_draw_indexの範囲を超える頂点数になった場合は逐次変換と同じくインデックスが溢れる
+class parallel_converter {
+public:
+    // allocatorは参加者ごとの変換用バッファに使う。nullptrならデフォルトのアロケータ
+    explicit parallel_converter(thread_pool& pool, const nk_allocator* allocator = nullptr);
+    ~parallel_converter();
+
+    parallel_converter(const parallel_converter&) = delete;
+    parallel_converter& operator=(const parallel_converter&) = delete;
+
+    // 1区間あたりの最小コマンド数。小さな区間は隣とまとめて1つのタスクにする
+    void set_min_segment_commands(std::size_t count) noexcept { m_min_segment_commands = count; }
+
+    // 各区間のnk_convert相当の結果(NK_CONVERT_*)の論理和を返す
+    nk_flags convert(const command_list& commands, const convert_options& options, draw_data& out);
+
+    // 直前のconvertで使った区間の数
+    std::size_t segment_count() const noexcept { return m_segments.size(); }
+
+private:
+    struct segment {
+        std::size_t first;
+        std::size_t last;
+        draw_data data;
+        nk_flags result;
+        std::size_t vertex_offset;
+        std::size_t index_offset;
+        std::size_t command_offset;
+    };
+
+    void split(const command_list& commands);
+
+    thread_pool& m_pool;
+    std::vector<std::unique_ptr<converter>> m_converters;
+    std::vector<segment> m_segments;
+    std::size_t m_min_segment_commands = 64;
+};
+
+} // namespace nk
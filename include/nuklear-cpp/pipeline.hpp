@@ -0,0 +1,80 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "nuklear-cpp/command_list.hpp"
+#include "nuklear-cpp/config.hpp"
+#include "nuklear-cpp/draw_data.hpp"
+
+namespace nk {
+
+// UI構築とnk_convertを別スレッドで並行させる
+// push()でコマンドキューをコピーしてワーカーに渡し、pop()で変換済みのフレームを受け取る
+// フレームは最大depth個まで同時に扱い、描画はpushからdepth-1フレーム遅れる
+//
+//   input → build → pipeline.push(ctx) → pipeline.pop(data) → nk_sdl_render_draw_data
+//
+// テキストのフォントやカスタムコマンドのコールバックは変換が終わるまで生存させ、
+// カスタムコマンドのコールバックはワーカースレッドで呼ばれることに注意する
+class convert_pipeline {
+public:
+    // allocatorはワーカーの変換用バッファに使う。nullptrならデフォルトのアロケータ
+    explicit convert_pipeline(const convert_options& options, std::size_t depth = 2,
+                              const nk_allocator* allocator = nullptr);
+    ~convert_pipeline();
+
+    convert_pipeline(const convert_pipeline&) = delete;
+    convert_pipeline& operator=(const convert_pipeline&) = delete;
+
+    // 以降にpushするフレームの変換設定を変える
+    void set_options(const convert_options& options);
+
+    // ctxのコマンドキューをコピーして変換を依頼し、nk_clear(ctx)する
+    // depth個のフレームが受け取られずに残っていれば、最も古いフレームの変換を待って捨てる
+    void push(nk_context* ctx);
+
+    // 最も古いフレームの変換が終わるのを待ち、その結果とoutの中身を入れ替える
+    // outの古い中身は次の変換で使い回す。変換中のフレームがなければfalse
+    bool pop(draw_data& out);
+    // 最も古いフレームの変換が終わっていればpop()と同じ。待たずにfalseを返す
+    bool try_pop(draw_data& out);
+
+    std::size_t depth() const noexcept { return m_slots.size(); }
+    // pushされてまだpopされていないフレームの数
+    std::size_t in_flight() const;
+    // 受け取られずに捨てられたフレームの数
+    std::size_t dropped() const;
+
+private:
+    struct slot {
+        command_list commands;
+        convert_options options;
+        draw_data data;
+    };
+
+    void run();
+    void take(draw_data& out);
+
+    std::vector<slot> m_slots;
+    convert_options m_options;
+    converter m_converter;
+
+    mutable std::mutex m_mutex;
+    std::condition_variable m_work;
+    std::condition_variable m_done;
+    // m_slotsをリングバッファとして使う
+    // m_headから数えてm_converted個が変換済み、残りのm_count - m_converted個が変換待ち
+    std::size_t m_head = 0;
+    std::size_t m_count = 0;
+    std::size_t m_converted = 0;
+    std::size_t m_dropped = 0;
+    bool m_stop = false;
+
+    std::thread m_worker;
+};
+
+} // namespace nk
@@ -0,0 +1,209 @@
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "nuklear-cpp/config.hpp"
+#include "nuklear-cpp/draw_data.hpp"
+
+// NUKLEAR_CPP_PROFILERが0ならprofilerの全ての操作は空のインライン関数になる
+// CMakeのNUKLEAR_CPP_ENABLE_PROFILERオプションで1に設定される
+#ifndef NUKLEAR_CPP_PROFILER
+#define NUKLEAR_CPP_PROFILER 0
+#endif
+
+namespace nk {
+
+// 1フレームの処理段階
+enum class profile_stage : std::size_t {
+    input,   // nk_input_begin から nk_input_end まで
+    build,   // nk_input_end から変換開始までのウィジェット構築
+    convert, // nk_convert
+    submit,  // バックエンドへの描画の発行
+    count,
+};
+
+enum class profile_counter : std::size_t {
+    commands,     // コマンドキューのコマンド数
+    vertices,
+    indices,
+    draw_calls,
+    clip_changes,
+    buffer_bytes, // nk_bufferから確保されたバイト数
+    count,
+};
+
+inline constexpr std::size_t profile_stage_count = static_cast<std::size_t>(profile_stage::count);
+inline constexpr std::size_t profile_counter_count = static_cast<std::size_t>(profile_counter::count);
+
+const char* to_string(profile_stage stage) noexcept;
+const char* to_string(profile_counter counter) noexcept;
+
+// 1フレーム分の計測結果
+struct frame_profile {
+    std::uint64_t frame = 0;
+    std::array<std::uint64_t, profile_stage_count> stage_ns{};
+    std::array<std::uint64_t, profile_counter_count> counters{};
+
+    std::uint64_t stage(profile_stage s) const noexcept { return stage_ns[static_cast<std::size_t>(s)]; }
+    std::uint64_t counter(profile_counter c) const noexcept { return counters[static_cast<std::size_t>(c)]; }
+};
+
+#if NUKLEAR_CPP_PROFILER
+
+// 直近Nフレームの段階ごとの時間とカウンタを記録する
+// begin_frame() → start()/stop()・カウンタの記録 → end_frame() の順に使う
+// スレッドセーフではない
+class profiler {
+public:
+    static constexpr bool enabled = true;
+    using clock = std::chrono::steady_clock;
+
+    explicit profiler(std::size_t history = 120)
+        : m_frames(history == 0 ? 1 : history) {}
+
+    void begin_frame() noexcept {
+        m_current = frame_profile{};
+        m_current.frame = m_frame_number;
+        m_started = {};
+    }
+
+    // 記録中のフレームをリングバッファに確定する
+    void end_frame() noexcept {
+        m_frames[m_next] = m_current;
+        m_next = (m_next + 1) % m_frames.size();
+        if (m_count < m_frames.size()) {
+            ++m_count;
+        }
+        ++m_frame_number;
+    }
+
+    void start(profile_stage stage) noexcept {
+        m_started[index(stage)] = clock::now();
+    }
+
+    // start()していない段階のstop()は無視する
+    void stop(profile_stage stage) noexcept {
+        auto& started = m_started[index(stage)];
+        if (started == clock::time_point{}) {
+            return;
+        }
+        const auto elapsed = clock::now() - started;
+        m_current.stage_ns[index(stage)] += static_cast<std::uint64_t>(
+            std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count());
+        started = clock::time_point{};
+    }
+
+    void add(profile_counter counter, std::uint64_t value) noexcept {
+        m_current.counters[index(counter)] += value;
+    }
+    void set(profile_counter counter, std::uint64_t value) noexcept {
+        m_current.counters[index(counter)] = value;
+    }
+
+    // コマンド数とコンテキストのコマンドバッファの使用量を記録する
+    // nk_clearより前に呼ぶ
+    void sample_context(nk_context* ctx) noexcept {
+        std::uint64_t commands = 0;
+        const nk_command* cmd = nullptr;
+        nk_foreach(cmd, ctx) {
+            ++commands;
+        }
+        set(profile_counter::commands, commands);
+        sample_buffer(ctx->memory);
+    }
+    void sample_buffer(const nk_buffer& buffer) noexcept {
+        add(profile_counter::buffer_bytes, buffer.allocated);
+    }
+    // 変換結果の頂点数とインデックス数を記録する
+    // nk_draw_commandの数は描画の発行回数とは限らないので、draw_callsはsample_submitで記録する
+    void sample_draw_data(const draw_data& data) noexcept {
+        set(profile_counter::vertices, data.vertices.size());
+        set(profile_counter::indices, data.indices.size());
+    }
+    // バックエンドが実際に発行した描画呼び出しとクリップ矩形の設定の回数
+    void sample_submit(std::uint64_t draw_calls, std::uint64_t clip_changes) noexcept {
+        set(profile_counter::draw_calls, draw_calls);
+        set(profile_counter::clip_changes, clip_changes);
+    }
+
+    // 記録済みのフレーム数(最大でhistory)
+    std::size_t size() const noexcept { return m_count; }
+    std::size_t capacity() const noexcept { return m_frames.size(); }
+    // 0が最も古いフレーム
+    const frame_profile& operator[](std::size_t i) const noexcept {
+        return m_frames[(m_next + m_frames.size() - m_count + i) % m_frames.size()];
+    }
+    const frame_profile& latest() const noexcept { return (*this)[m_count - 1]; }
+    const frame_profile& current() const noexcept { return m_current; }
+
+    // 記録済みのフレームをCSVで書き出す
+    bool dump(const char* path) const;
+
+private:
+    template <class E>
+    static constexpr std::size_t index(E e) noexcept { return static_cast<std::size_t>(e); }
+
+    std::vector<frame_profile> m_frames;
+    std::size_t m_next = 0;
+    std::size_t m_count = 0;
+    std::uint64_t m_frame_number = 0;
+    frame_profile m_current;
+    std::array<clock::time_point, profile_stage_count> m_started{};
+};
+
+#else
+
+// 計測が無効な場合の空の実装
+class profiler {
+public:
+    static constexpr bool enabled = false;
+
+    explicit profiler(std::size_t = 120) noexcept {}
+
+    void begin_frame() noexcept {}
+    void end_frame() noexcept {}
+    void start(profile_stage) noexcept {}
+    void stop(profile_stage) noexcept {}
+    void add(profile_counter, std::uint64_t) noexcept {}
+    void set(profile_counter, std::uint64_t) noexcept {}
+    void sample_context(nk_context*) noexcept {}
+    void sample_buffer(const nk_buffer&) noexcept {}
+    void sample_draw_data(const draw_data&) noexcept {}
+    void sample_submit(std::uint64_t, std::uint64_t) noexcept {}
+
+    std::size_t size() const noexcept { return 0; }
+    std::size_t capacity() const noexcept { return 0; }
+    const frame_profile& operator[](std::size_t) const noexcept { return m_empty; }
+    const frame_profile& latest() const noexcept { return m_empty; }
+    const frame_profile& current() const noexcept { return m_empty; }
+
+    bool dump(const char*) const noexcept { return false; }
+
+private:
+    frame_profile m_empty;
+};
+
+#endif
+
+// スコープの間を1つの段階として計測する
+class profile_scope {
+public:
+    profile_scope(profiler& p, profile_stage stage) noexcept
+        : m_profiler(p), m_stage(stage) {
+        m_profiler.start(m_stage);
+    }
+    ~profile_scope() { m_profiler.stop(m_stage); }
+
+    profile_scope(const profile_scope&) = delete;
+    profile_scope& operator=(const profile_scope&) = delete;
+
+private:
+    profiler& m_profiler;
+    profile_stage m_stage;
+};
+
+} // namespace nk
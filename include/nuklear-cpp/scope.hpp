@@ -0,0 +1,129 @@
+#pragma once
+
+#include <source_location>
+
+#include "nuklear-cpp/config.hpp"
+
+namespace nk {
+
+// nk_begin/nk_endの組を管理する
+// nk_endはnk_beginの戻り値に関わらず呼ぶ必要があるので、デストラクタで必ず呼ぶ
+class window {
+public:
+    window(nk_context* ctx, const char* title, struct nk_rect bounds, nk_flags flags) noexcept
+        : m_ctx(ctx), m_open(nk_begin(ctx, title, bounds, flags)) {}
+    window(nk_context* ctx, const char* name, const char* title, struct nk_rect bounds, nk_flags flags) noexcept
+        : m_ctx(ctx), m_open(nk_begin_titled(ctx, name, title, bounds, flags)) {}
+    ~window() { nk_end(m_ctx); }
+
+    window(const window&) = delete;
+    window& operator=(const window&) = delete;
+
+    explicit operator bool() const noexcept { return m_open; }
+    nk_context* context() const noexcept { return m_ctx; }
+
+private:
+    nk_context* m_ctx;
+    bool m_open;
+};
+
+namespace detail {
+
+// 開始関数が成功した時だけ終了関数を呼ぶスコープ
+template <void (*End)(nk_context*)>
+class conditional_scope {
+public:
+    conditional_scope(nk_context* ctx, bool open) noexcept : m_ctx(ctx), m_open(open) {}
+    ~conditional_scope() {
+        if (m_open) {
+            End(m_ctx);
+        }
+    }
+
+    conditional_scope(const conditional_scope&) = delete;
+    conditional_scope& operator=(const conditional_scope&) = delete;
+
+    explicit operator bool() const noexcept { return m_open; }
+    nk_context* context() const noexcept { return m_ctx; }
+
+private:
+    nk_context* m_ctx;
+    bool m_open;
+};
+
+} // namespace detail
+
+using combo = detail::conditional_scope<nk_combo_end>;
+using group = detail::conditional_scope<nk_group_end>;
+using scrolled_group = detail::conditional_scope<nk_group_scrolled_end>;
+using tree = detail::conditional_scope<nk_tree_pop>;
+using popup = detail::conditional_scope<nk_popup_end>;
+
+// コンボボックス
+// 呼び出し側で変数に受けないとその場で閉じてしまうので[[nodiscard]]にする
+[[nodiscard]] inline combo combo_label(nk_context* ctx, const char* selected, struct nk_vec2 size) noexcept {
+    return {ctx, nk_combo_begin_label(ctx, selected, size) != 0};
+}
+[[nodiscard]] inline combo combo_text(nk_context* ctx, const char* selected, int len, struct nk_vec2 size) noexcept {
+    return {ctx, nk_combo_begin_text(ctx, selected, len, size) != 0};
+}
+[[nodiscard]] inline combo combo_color(nk_context* ctx, nk_color color, struct nk_vec2 size) noexcept {
+    return {ctx, nk_combo_begin_color(ctx, color, size) != 0};
+}
+[[nodiscard]] inline combo combo_symbol(nk_context* ctx, nk_symbol_type symbol, struct nk_vec2 size) noexcept {
+    return {ctx, nk_combo_begin_symbol(ctx, symbol, size) != 0};
+}
+[[nodiscard]] inline combo combo_symbol_label(
+    nk_context* ctx, const char* selected, nk_symbol_type symbol, struct nk_vec2 size) noexcept {
+    return {ctx, nk_combo_begin_symbol_label(ctx, selected, symbol, size) != 0};
+}
+[[nodiscard]] inline combo combo_image(nk_context* ctx, struct nk_image img, struct nk_vec2 size) noexcept {
+    return {ctx, nk_combo_begin_image(ctx, img, size) != 0};
+}
+[[nodiscard]] inline combo combo_image_label(
+    nk_context* ctx, const char* selected, struct nk_image img, struct nk_vec2 size) noexcept {
+    return {ctx, nk_combo_begin_image_label(ctx, selected, img, size) != 0};
+}
+
+// グループ
+[[nodiscard]] inline group group_begin(nk_context* ctx, const char* title, nk_flags flags) noexcept {
+    return {ctx, nk_group_begin(ctx, title, flags) != 0};
+}
+[[nodiscard]] inline group group_begin(
+    nk_context* ctx, const char* name, const char* title, nk_flags flags) noexcept {
+    return {ctx, nk_group_begin_titled(ctx, name, title, flags) != 0};
+}
+// スクロール位置を呼び出し側で保持するグループ
+[[nodiscard]] inline scrolled_group group_scrolled(
+    nk_context* ctx, nk_uint& x_offset, nk_uint& y_offset, const char* title, nk_flags flags) noexcept {
+    return {ctx, nk_group_scrolled_offset_begin(ctx, &x_offset, &y_offset, title, flags) != 0};
+}
+
+// ツリー
+// NK_TREE_PUSHマクロと同じく、呼び出し位置をハッシュのキーにする
+[[nodiscard]] inline tree tree_push(
+    nk_context* ctx, nk_tree_type type, const char* title, nk_collapse_states state,
+    std::source_location location = std::source_location::current()) noexcept {
+    const char* file = location.file_name();
+    return {ctx, nk_tree_push_hashed(ctx, type, title, state, file, nk_strlen(file),
+                                     static_cast<int>(location.line())) != 0};
+}
+// ループ内などで同じ位置から複数のノードを作る時はidで区別する
+// NK_TREE_PUSH_IDのキー(NK_FILE_LINE)と同じく行番号も含めるため、ファイル名を行番号で
+// ハッシュした値をキーにし、idをシードにする。同じファイルの別の位置とは状態を共有しない
+[[nodiscard]] inline tree tree_push_id(
+    nk_context* ctx, nk_tree_type type, const char* title, nk_collapse_states state, int id,
+    std::source_location location = std::source_location::current()) noexcept {
+    const char* file = location.file_name();
+    const nk_hash key = nk_murmur_hash(file, nk_strlen(file), static_cast<nk_hash>(location.line()));
+    return {ctx, nk_tree_push_hashed(ctx, type, title, state, reinterpret_cast<const char*>(&key),
+                                     static_cast<int>(sizeof(key)), id) != 0};
+}
+
+// ポップアップ
+[[nodiscard]] inline popup popup_begin(
+    nk_context* ctx, nk_popup_type type, const char* title, nk_flags flags, struct nk_rect bounds) noexcept {
+    return {ctx, nk_popup_begin(ctx, type, title, flags, bounds) != 0};
+}
+
+} // namespace nk
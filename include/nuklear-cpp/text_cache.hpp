@@ -0,0 +1,95 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "nuklear-cpp/config.hpp"
+#include "nuklear-cpp/vertex_layout.hpp"
+
+namespace nk {
+
+// 文字列ごとのグリフの四角形のキャッシュ
+// フォント・高さ・色・文字列が同じテキストは、前に作った頂点を位置だけずらしてコピーする
+// UTF-8の解析とグリフの検索は最初の1回だけになる
+// フォントのアトラスを作り直した時はclearを呼ぶ。スレッドセーフではない
+class text_cache {
+public:
+    // 頂点の位置は描画先の矩形の左上を原点にしている
+    struct run {
+        std::string text;
+        const nk_user_font* font = nullptr;
+        float height = 0.0f;
+        nk_color color{};
+        std::vector<vertex> vertices;
+        std::uint64_t last_used = 0;
+    };
+
+    // 直近max_age回のnext_frameの間に使われなかった文字列は捨てる
+    explicit text_cache(std::uint64_t max_age = 120) noexcept : m_max_age(max_age) {}
+
+    // 見つからなければnullptr
+    const run* find(std::string_view text, const nk_user_font* font, float height, nk_color color) noexcept;
+    // 頂点が空のエントリを作って返す。同じキーのエントリがあれば置き換える
+    run& insert(std::string_view text, const nk_user_font* font, float height, nk_color color);
+
+    // フレームの区切り。古い文字列を捨て、hits/missesを0に戻す
+    void next_frame();
+    void clear() noexcept;
+
+    std::size_t size() const noexcept { return m_runs.size(); }
+    // 直前のnext_frameから後のfind/insertの回数
+    std::size_t hits() const noexcept { return m_hits; }
+    std::size_t misses() const noexcept { return m_misses; }
+
+private:
+    std::unordered_map<std::uint64_t, run> m_runs;
+    std::uint64_t m_frame = 0;
+    std::uint64_t m_max_age;
+    std::size_t m_hits = 0;
+    std::size_t m_misses = 0;
+};
+
+// 文字列の幅を覚えるnk_user_font
+// font()をnk_init等に渡すと、同じ高さ・文字列の幅は元のフォントのwidthを呼ばずに返す
+// queryとtextureは元のフォントのものをそのまま使う
+// 元のフォントはこのオブジェクトより長く生存していなければならない
+class cached_font {
+public:
+    explicit cached_font(const nk_user_font& base, std::uint64_t max_age = 120);
+
+    cached_font(const cached_font&) = delete;
+    cached_font& operator=(const cached_font&) = delete;
+
+    nk_user_font* font() noexcept { return &m_font; }
+    const nk_user_font* font() const noexcept { return &m_font; }
+
+    // フレームの区切り。直近max_age回の間に使われなかった幅を捨てる
+    void next_frame();
+    void clear() noexcept { m_widths.clear(); }
+
+    std::size_t size() const noexcept { return m_widths.size(); }
+
+private:
+    struct entry {
+        std::string text;
+        float height;
+        float width;
+        std::uint64_t last_used;
+    };
+
+    static float width(nk_handle handle, float height, const char* text, int len);
+    static void query(nk_handle handle, float height, struct nk_user_font_glyph* glyph, nk_rune codepoint,
+                      nk_rune next_codepoint);
+
+    nk_user_font m_base;
+    nk_user_font m_font;
+    std::unordered_map<std::uint64_t, entry> m_widths;
+    std::uint64_t m_frame = 0;
+    std::uint64_t m_max_age;
+};
+
+} // namespace nk
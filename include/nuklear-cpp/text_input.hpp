@@ -0,0 +1,65 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+
+#include "nuklear-cpp/config.hpp"
+
+namespace nk {
+
+// クリップボードの実体。プラットフォームごとに用意する
+struct clipboard_backend {
+    void* userdata = nullptr;
+    // 貼り付ける文字列。release(userdata, text)を呼ぶまで有効でなければならない
+    std::string_view (*get)(void* userdata) = nullptr;
+    void (*release)(void* userdata, std::string_view text) = nullptr;
+    // NUL終端の文字列をクリップボードに置く
+    void (*set)(void* userdata, const char* text) = nullptr;
+};
+
+// nk_contextのクリップボードと文字入力の受け口
+// コピーは使い回すバッファでNUL終端にしてから渡すので、毎回の確保がない
+// 貼り付けはバックエンドの文字列をコピーせずに、1フレームにpaste_chunkバイトずつ
+// nk_textedit_pasteへ流し込む。数MBのログを貼っても1フレームが止まらない
+// 文字入力も1フレームに入る分(NK_INPUT_MAXバイト)を超えたら次のフレームへ回す
+class text_input {
+public:
+    explicit text_input(const clipboard_backend& backend = {}, std::size_t paste_chunk = 64 * 1024);
+    ~text_input();
+
+    text_input(const text_input&) = delete;
+    text_input& operator=(const text_input&) = delete;
+
+    // ctxのクリップボードの呼び出し先をこのオブジェクトにする
+    void install(nk_context* ctx) noexcept;
+
+    // 入力された文字列(UTF-8)を積む
+    void feed(std::string_view utf8);
+    // nk_input_beginとnk_input_endの間で毎フレーム呼ぶ
+    // 積んだ文字を入る分だけ渡し、貼り付けの途中ならその続きを要求する
+    void update(nk_context* ctx);
+
+    bool pasting() const noexcept { return !m_paste.empty(); }
+    // 次のフレームに渡す文字か貼り付けの続きが残っている
+    bool pending() const noexcept { return pasting() || m_text_offset < m_text.size(); }
+    // 貼り付けの残りを捨てる。途中で編集欄からフォーカスが外れた時にも呼ばれる
+    void cancel_paste() noexcept;
+
+private:
+    static void copy(nk_handle handle, const char* text, int len);
+    static void paste(nk_handle handle, nk_text_edit* edit);
+
+    clipboard_backend m_backend;
+    std::size_t m_paste_chunk;
+    std::string m_scratch;
+    std::string m_text;
+    std::size_t m_text_offset = 0;
+    // バックエンドから受け取った文字列全体と、まだ貼っていない部分
+    std::string_view m_paste_source;
+    std::string_view m_paste;
+    // 続きを貼るための貼り付けキーを送ったが、まだ編集欄に受け取られていない
+    bool m_paste_requested = false;
+};
+
+} // namespace nk
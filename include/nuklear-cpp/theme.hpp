@@ -0,0 +1,185 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+#include "nuklear-cpp/config.hpp"
+
+namespace nk {
+
+// nk_style_from_tableに渡す色の表
+using color_table = std::array<nk_color, NK_COLOR_COUNT>;
+
+// 0xRRGGBBAA
+constexpr nk_color rgba(std::uint32_t value) noexcept {
+    return nk_color{static_cast<nk_byte>(value >> 24), static_cast<nk_byte>(value >> 16),
+                    static_cast<nk_byte>(value >> 8), static_cast<nk_byte>(value)};
+}
+// 0xRRGGBB
+constexpr nk_color rgb(std::uint32_t value) noexcept {
+    return rgba(value << 8 | 0xff);
+}
+// nk_rgba_fと同じく[0, 1]に収めて255倍し、切り捨てる
+constexpr nk_color rgba_f(float r, float g, float b, float a = 1.0f) noexcept {
+    const auto byte = [](float v) { return static_cast<nk_byte>(std::clamp(v, 0.0f, 1.0f) * 255.0f); };
+    return nk_color{byte(r), byte(g), byte(b), byte(a)};
+}
+// nk_rgba_cfと同じ変換。定数の色はコンパイル時に済ませる
+constexpr nk_color rgba_cf(nk_colorf c) noexcept {
+    return rgba_f(c.r, c.g, c.b, c.a);
+}
+// nk_rgb_cfと同じく、アルファは不透明にする
+constexpr nk_color rgb_cf(nk_colorf c) noexcept {
+    return rgba_f(c.r, c.g, c.b, 1.0f);
+}
+
+// 表の1項目
+struct color_entry {
+    nk_style_colors index;
+    nk_color color;
+};
+
+// 全ての項目をちょうど1回ずつ指定した表を作る
+// 抜けや重複、範囲外の項目があればコンパイルエラーになる。Nuklearの更新で項目が増えた時も気付ける
+template <std::size_t N>
+consteval color_table make_color_table(const color_entry (&entries)[N]) {
+    color_table table{};
+    std::array<bool, NK_COLOR_COUNT> assigned{};
+    for (const color_entry& e : entries) {
+        const auto i = static_cast<std::size_t>(e.index);
+        if (i >= assigned.size()) {
+            throw "color index out of range";
+        }
+        if (assigned[i]) {
+            throw "color assigned twice";
+        }
+        assigned[i] = true;
+        table[i] = e.color;
+    }
+    for (const bool a : assigned) {
+        if (!a) {
+            throw "color left unassigned";
+        }
+    }
+    return table;
+}
+
+// 少数の基本色。残りの項目はここから決める
+struct palette {
+    nk_color text;
+    nk_color window;
+    nk_color header;
+    nk_color border;
+    // ボタン、スライダーの溝、入力欄などの地の色
+    nk_color control;
+    nk_color control_hover;
+    nk_color control_active;
+    // スライダーやスクロールバーのつまみ、チェックの印、グラフの線
+    nk_color accent;
+    nk_color accent_hover;
+    nk_color accent_active;
+    // グラフの強調
+    nk_color highlight;
+};
+
+// 基本色から表を作る。知らない項目(Nuklearの更新で増えたもの)はcontrolにする
+constexpr color_table make_color_table(const palette& p) noexcept {
+    color_table table{};
+    for (std::size_t i = 0; i < table.size(); ++i) {
+        nk_color c = p.control;
+        switch (static_cast<nk_style_colors>(i)) {
+        case NK_COLOR_TEXT: c = p.text; break;
+        case NK_COLOR_WINDOW: c = p.window; break;
+        case NK_COLOR_HEADER: c = p.header; break;
+        case NK_COLOR_BORDER: c = p.border; break;
+        case NK_COLOR_BUTTON: c = p.control; break;
+        case NK_COLOR_BUTTON_HOVER: c = p.control_hover; break;
+        case NK_COLOR_BUTTON_ACTIVE: c = p.control_active; break;
+        case NK_COLOR_TOGGLE: c = p.control_hover; break;
+        case NK_COLOR_TOGGLE_HOVER: c = p.control_active; break;
+        case NK_COLOR_TOGGLE_CURSOR: c = p.accent; break;
+        case NK_COLOR_SELECT: c = p.control; break;
+        case NK_COLOR_SELECT_ACTIVE: c = p.control_active; break;
+        case NK_COLOR_SLIDER: c = p.control; break;
+        case NK_COLOR_SLIDER_CURSOR: c = p.accent; break;
+        case NK_COLOR_SLIDER_CURSOR_HOVER: c = p.accent_hover; break;
+        case NK_COLOR_SLIDER_CURSOR_ACTIVE: c = p.accent_active; break;
+        case NK_COLOR_PROPERTY: c = p.control; break;
+        case NK_COLOR_EDIT: c = p.control; break;
+        case NK_COLOR_EDIT_CURSOR: c = p.text; break;
+        case NK_COLOR_COMBO: c = p.control; break;
+        case NK_COLOR_CHART: c = p.control; break;
+        case NK_COLOR_CHART_COLOR: c = p.accent; break;
+        case NK_COLOR_CHART_COLOR_HIGHLIGHT: c = p.highlight; break;
+        case NK_COLOR_SCROLLBAR: c = p.window; break;
+        case NK_COLOR_SCROLLBAR_CURSOR: c = p.accent; break;
+        case NK_COLOR_SCROLLBAR_CURSOR_HOVER: c = p.accent_hover; break;
+        case NK_COLOR_SCROLLBAR_CURSOR_ACTIVE: c = p.accent_active; break;
+        case NK_COLOR_TAB_HEADER: c = p.header; break;
+        default: break;
+        }
+        table[i] = c;
+    }
+    return table;
+}
+
+// 組み込みの配色。Nuklearのdemo/common/style.cのテーマに近い色にしてある
+namespace themes {
+
+inline constexpr color_table dark = make_color_table(palette{
+    rgb(0xd2d2d3), rgb(0x394347), rgb(0x333338), rgb(0x2e2e2e), rgb(0x30536f), rgb(0x3a5d79), rgb(0x3f627e),
+    rgb(0x5f7f9a), rgb(0x6a8aa5), rgb(0x7595b0), rgb(0xff0000)});
+
+inline constexpr color_table light = make_color_table(palette{
+    rgb(0x464646), rgb(0xafafaf), rgb(0xafafaf), rgb(0x000000), rgb(0xb9b9b9), rgb(0xaaaaaa), rgb(0xa0a0a0),
+    rgb(0x505050), rgb(0x464646), rgb(0x3c3c3c), rgb(0xff0000)});
+
+inline constexpr color_table red = make_color_table(palette{
+    rgb(0xbebebe), rgb(0x1e2128), rgb(0xb5292b), rgb(0x337780), rgb(0x322d2d), rgb(0x46282d), rgb(0x4b2a2d),
+    rgb(0xb9323c), rgb(0xc83742), rgb(0xdc3c46), rgb(0xff0000)});
+
+inline constexpr color_table blue = make_color_table(palette{
+    rgb(0x14141e), rgb(0xcad2dc), rgb(0x89b6e1), rgb(0x2e2e2e), rgb(0x89b6e1), rgb(0x8ebbe6), rgb(0x93c0eb),
+    rgb(0x3a75ae), rgb(0x4570b2), rgb(0x4a7ab7), rgb(0xff0000)});
+
+} // namespace themes
+
+// 色の表から一度だけnk_style_from_tableで作ったnk_styleを持つ
+// 切り替えはnk_styleの複写だけで、毎回全てのウィジェットの色を計算し直さない
+// フォントとカーソルはnk_contextのものを残す
+class theme {
+public:
+    // ctxはnk_style_from_tableを呼ぶ作業場所に使い、ctx->styleは元に戻す
+    theme(nk_context* ctx, const color_table& colors);
+
+    const color_table& colors() const noexcept { return m_colors; }
+    const nk_style& style() const noexcept { return m_style; }
+
+    // ctxのスタイルをこのテーマにする
+    void apply(nk_context* ctx) const noexcept;
+
+private:
+    color_table m_colors;
+    nk_style m_style;
+};
+
+// スコープの間だけテーマを切り替え、抜ける時に元の色を書き戻す。フォントとカーソルは戻さない
+// ウィンドウの枠やスクロールバーはnk_endでも描くので、nk_beginより前に作ってnk_endより後に壊す
+// 元のスタイルはこのオブジェクトに取っておくので、nk_style_push_*の固定長のスタックを使わず、
+// 入れ子の深さに制限がない
+class theme_scope {
+public:
+    theme_scope(nk_context* ctx, const theme& t) noexcept;
+    ~theme_scope();
+
+    theme_scope(const theme_scope&) = delete;
+    theme_scope& operator=(const theme_scope&) = delete;
+
+private:
+    nk_context* m_ctx;
+    nk_style m_saved;
+};
+
+} // namespace nk
@@ -0,0 +1,56 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace nk {
+
+// parallel_for専用のワークスティーリング型スレッドプール
+// 呼び出し元のスレッドも参加者0として処理するので、threads個のうち
+// threads - 1個だけスレッドを作る
+class thread_pool {
+public:
+    explicit thread_pool(std::size_t threads = std::thread::hardware_concurrency());
+    ~thread_pool();
+
+    thread_pool(const thread_pool&) = delete;
+    thread_pool& operator=(const thread_pool&) = delete;
+
+    // 呼び出し元を含めた参加者の数
+    std::size_t size() const noexcept { return m_queues.size(); }
+
+    // [0, count)の各iについてfn(i, 参加者番号)を呼び、全て終わるまで待つ
+    // 添字は参加者ごとに連続した範囲で配り、手の空いた参加者は他の参加者の範囲の先頭から奪う
+    // 同時に呼べるのは1スレッドだけ
+    void parallel_for(std::size_t count, const std::function<void(std::size_t, std::size_t)>& fn);
+
+private:
+    struct queue {
+        std::mutex mutex;
+        std::deque<std::size_t> tasks;
+    };
+
+    void worker(std::size_t participant);
+    void drain(std::size_t participant);
+    bool pop(std::size_t participant, std::size_t& task);
+
+    std::vector<std::unique_ptr<queue>> m_queues;
+    std::vector<std::thread> m_threads;
+
+    std::mutex m_mutex;
+    std::condition_variable m_start;
+    std::condition_variable m_finish;
+    std::size_t m_generation = 0;
+    bool m_stop = false;
+    const std::function<void(std::size_t, std::size_t)>* m_job = nullptr;
+    std::atomic<std::size_t> m_pending{0};
+};
+
+} // namespace nk
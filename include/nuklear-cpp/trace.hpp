@@ -0,0 +1,106 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "nuklear-cpp/command_list.hpp"
+#include "nuklear-cpp/config.hpp"
+
+namespace nk {
+
+// 1フレーム分の入力。nk_input_endの後のnk_context::inputから取る
+struct input_snapshot {
+    struct nk_vec2 mouse_pos{};
+    struct nk_vec2 mouse_prev{};
+    struct nk_vec2 mouse_delta{};
+    struct nk_vec2 scroll_delta{};
+    std::uint8_t mouse_down[NK_BUTTON_MAX]{};
+    std::uint8_t mouse_clicked[NK_BUTTON_MAX]{};
+    struct nk_vec2 clicked_pos[NK_BUTTON_MAX]{};
+    std::uint8_t key_down[NK_KEY_MAX]{};
+    std::uint8_t key_clicked[NK_KEY_MAX]{};
+    std::string text;
+
+    static input_snapshot capture(const nk_context* ctx);
+};
+
+// トレースの1フレーム
+struct trace_frame {
+    std::uint64_t index = 0;
+    // 記録を始めてからの経過時間
+    std::uint64_t time_us = 0;
+    input_snapshot input;
+    command_list commands;
+};
+
+// フレームごとの入力とコマンドキューをトレースファイルに書き出す
+// フレームは書いた時点でファイルに追記されるので、途中で止めてもそこまでは読める
+// テキストのフォントはポインタの代わりに番号と高さを、画像のハンドルとカスタムコマンドの
+// コールバックは0を書く。再生側では別のフォントとテクスチャで描くことになる
+// 数値は書いたマシンのバイト順のまま置く
+class trace_writer {
+public:
+    // width/heightは記録する画面の大きさ。再生側の描画先の大きさに使う
+    trace_writer(const std::filesystem::path& path, int width, int height);
+
+    trace_writer(const trace_writer&) = delete;
+    trace_writer& operator=(const trace_writer&) = delete;
+
+    bool is_open() const noexcept { return m_file.is_open() && m_file.good(); }
+
+    // ctxの入力とコマンドキューを1フレームとして書く
+    // nk_foreachでコマンドを辿るので、nk_clear(nk_sdl_render等)より前に呼ぶ
+    void write_frame(nk_context* ctx);
+    void write_frame(const input_snapshot& input, const command_list& commands);
+    void flush() { m_file.flush(); }
+
+    std::uint64_t frame_count() const noexcept { return m_frames; }
+
+private:
+    std::uint32_t font_id(const nk_user_font* font);
+
+    std::ofstream m_file;
+    std::chrono::steady_clock::time_point m_start;
+    command_list m_commands;
+    std::vector<const nk_user_font*> m_fonts;
+    std::vector<std::byte> m_buffer;
+    std::uint64_t m_frames = 0;
+};
+
+// trace_writerが書いたファイルを先頭から1フレームずつ読む
+class trace_reader {
+public:
+    explicit trace_reader(const std::filesystem::path& path);
+
+    trace_reader(const trace_reader&) = delete;
+    trace_reader& operator=(const trace_reader&) = delete;
+
+    // ヘッダを読めたかどうか
+    bool is_open() const noexcept { return m_valid; }
+    int width() const noexcept { return m_width; }
+    int height() const noexcept { return m_height; }
+
+    // テキストのコマンドを描くフォント。nullptrのままならテキストのコマンドは読み飛ばす
+    void set_font(const nk_user_font* font) noexcept { m_font = font; }
+    // これまでに読んだフォントの、番号ごとの記録時の高さ
+    const std::vector<float>& font_heights() const noexcept { return m_font_heights; }
+
+    // 次のフレームを読む。終わりに達したか、壊れた部分に当たったらfalse
+    bool next(trace_frame& frame);
+
+private:
+    std::ifstream m_file;
+    bool m_valid = false;
+    int m_width = 0;
+    int m_height = 0;
+    const nk_user_font* m_font = nullptr;
+    std::vector<float> m_font_heights;
+    std::vector<std::byte> m_buffer;
+};
+
+} // namespace nk
@@ -0,0 +1,25 @@
+#pragma once
+
+#include "nuklear-cpp/config.hpp"
+
+namespace nk {
+
+class text_cache;
+
+// nk_draw_list_path_stroke/nk_draw_list_path_fillと同じ頂点とインデックスを、
+// nk::vertexのレイアウトへ直接書き込む
+// 属性ごとの形式の分岐と色の浮動小数点変換を省き、法線と縁(アンチエイリアス用の
+// 半透明の帯)の計算はビルド時に使える命令セット(AVX2/SSE2)でまとめて行う
+// listはmake_convert_configの設定でセットアップされていなければならない
+void stroke_path(nk_draw_list& list, nk_color color, nk_draw_list_stroke closed, float thickness);
+void fill_path(nk_draw_list& list, nk_color color);
+
+// nk_draw_list_add_textと同じグリフの四角形を書き込む
+// cacheがあれば同じ文字列の頂点を使い回す。nullptrならnk_draw_list_add_textを呼ぶだけ
+void add_text(nk_draw_list& list, const nk_user_font* font, struct nk_rect rect, const char* text, int len,
+              float height, nk_color color, text_cache* cache);
+
+// stroke_path/fill_pathが使う命令セットの名前("avx2", "sse2", "scalar")
+const char* vertex_kernel_isa() noexcept;
+
+} // namespace nk
@@ -0,0 +1,196 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <type_traits>
+
+#include "nuklear-cpp/config.hpp"
+
+namespace nk {
+
+// SDLバックエンドのnk_sdl_vertexと同じレイアウトの頂点
+struct vertex {
+    float position[2];
+    float uv[2];
+    nk_byte col[4];
+};
+
+// 頂点の1つの属性の形式と位置
+// scaleは書き込む前に掛ける値。UVを正規化した16ビット整数で持つ場合などに使う
+struct vertex_attribute {
+    nk_draw_vertex_layout_format format;
+    std::size_t offset;
+    float scale = 1.0f;
+};
+
+// 頂点型Vertexの属性の並び
+// 利用側はposition, uv, colorの3つのconstexprなvertex_attributeを持つ特殊化を用意する
+//
+//   template <>
+//   struct nk::vertex_format<packed_vertex> {
+//       static constexpr vertex_attribute position{NK_FORMAT_SSHORT, offsetof(packed_vertex, x)};
+//       static constexpr vertex_attribute uv{NK_FORMAT_USHORT, offsetof(packed_vertex, u), 65535.0f};
+//       static constexpr vertex_attribute color{NK_FORMAT_R8G8B8A8, offsetof(packed_vertex, rgba)};
+//   };
+template <class Vertex>
+struct vertex_format;
+
+template <>
+struct vertex_format<vertex> {
+    static constexpr vertex_attribute position{NK_FORMAT_FLOAT, offsetof(vertex, position)};
+    static constexpr vertex_attribute uv{NK_FORMAT_FLOAT, offsetof(vertex, uv)};
+    static constexpr vertex_attribute color{NK_FORMAT_R8G8B8A8, offsetof(vertex, col)};
+};
+
+namespace detail {
+
+// 位置とUVに使える形式の1成分のバイト数。使えない形式なら0
+constexpr std::size_t component_size(nk_draw_vertex_layout_format format) noexcept {
+    switch (format) {
+    case NK_FORMAT_SCHAR:
+    case NK_FORMAT_UCHAR:
+        return 1;
+    case NK_FORMAT_SSHORT:
+    case NK_FORMAT_USHORT:
+        return 2;
+    case NK_FORMAT_SINT:
+    case NK_FORMAT_UINT:
+    case NK_FORMAT_FLOAT:
+        return 4;
+    case NK_FORMAT_DOUBLE:
+        return 8;
+    default:
+        return 0;
+    }
+}
+
+// 色に使える形式のバイト数。使えない形式なら0
+constexpr std::size_t color_size(nk_draw_vertex_layout_format format) noexcept {
+    switch (format) {
+    case NK_FORMAT_R8G8B8A8:
+    case NK_FORMAT_B8G8R8A8:
+    case NK_FORMAT_RGBA32:
+        return 4;
+    case NK_FORMAT_R32G32B32A32_FLOAT:
+        return 16;
+    default:
+        return 0;
+    }
+}
+
+constexpr bool overlaps(std::size_t a, std::size_t a_size, std::size_t b, std::size_t b_size) noexcept {
+    return a < b + b_size && b < a + a_size;
+}
+
+constexpr bool same_attribute(const vertex_attribute& a, const vertex_attribute& b) noexcept {
+    return a.format == b.format && a.offset == b.offset && a.scale == b.scale;
+}
+
+template <nk_draw_vertex_layout_format Format>
+struct component;
+template <> struct component<NK_FORMAT_SCHAR> { using type = std::int8_t; };
+template <> struct component<NK_FORMAT_SSHORT> { using type = std::int16_t; };
+template <> struct component<NK_FORMAT_SINT> { using type = std::int32_t; };
+template <> struct component<NK_FORMAT_UCHAR> { using type = std::uint8_t; };
+template <> struct component<NK_FORMAT_USHORT> { using type = std::uint16_t; };
+template <> struct component<NK_FORMAT_UINT> { using type = std::uint32_t; };
+template <> struct component<NK_FORMAT_FLOAT> { using type = float; };
+template <> struct component<NK_FORMAT_DOUBLE> { using type = double; };
+
+// nk_draw_vertex_elementと同じく、整数へは範囲に収めてから切り捨てる
+template <nk_draw_vertex_layout_format Format>
+void write_components(std::byte* dst, float x, float y) noexcept {
+    using T = typename component<Format>::type;
+    T values[2];
+    if constexpr (std::is_floating_point_v<T>) {
+        values[0] = static_cast<T>(x);
+        values[1] = static_cast<T>(y);
+    } else {
+        constexpr auto lo = static_cast<float>(std::numeric_limits<T>::min());
+        constexpr auto hi = static_cast<float>(std::numeric_limits<T>::max());
+        values[0] = static_cast<T>(std::clamp(x, lo, hi));
+        values[1] = static_cast<T>(std::clamp(y, lo, hi));
+    }
+    std::memcpy(dst, values, sizeof(values));
+}
+
+// rgbaはR8G8B8A8の並び
+template <nk_draw_vertex_layout_format Format>
+void write_color(std::byte* dst, const nk_byte* rgba) noexcept {
+    if constexpr (Format == NK_FORMAT_R8G8B8A8) {
+        std::memcpy(dst, rgba, 4);
+    } else if constexpr (Format == NK_FORMAT_B8G8R8A8) {
+        const nk_byte bgra[4] = {rgba[2], rgba[1], rgba[0], rgba[3]};
+        std::memcpy(dst, bgra, sizeof(bgra));
+    } else if constexpr (Format == NK_FORMAT_RGBA32) {
+        // nk_color_u32と同じく赤を最下位に置く
+        const std::uint32_t packed = static_cast<std::uint32_t>(rgba[0]) | static_cast<std::uint32_t>(rgba[1]) << 8 |
+                                     static_cast<std::uint32_t>(rgba[2]) << 16 |
+                                     static_cast<std::uint32_t>(rgba[3]) << 24;
+        std::memcpy(dst, &packed, sizeof(packed));
+    } else {
+        constexpr float s = 1.0f / 255.0f;
+        const float rgbaf[4] = {rgba[0] * s, rgba[1] * s, rgba[2] * s, rgba[3] * s};
+        std::memcpy(dst, rgbaf, sizeof(rgbaf));
+    }
+}
+
+} // namespace detail
+
+// vertex_format<Vertex>から求めたレイアウト。不正なレイアウトはコンパイル時に弾く
+template <class Vertex>
+struct vertex_layout {
+    using traits = vertex_format<Vertex>;
+    static constexpr vertex_attribute position = traits::position;
+    static constexpr vertex_attribute uv = traits::uv;
+    static constexpr vertex_attribute color = traits::color;
+
+    static constexpr std::size_t size = sizeof(Vertex);
+    static constexpr std::size_t alignment = alignof(Vertex);
+    static constexpr std::size_t position_size = 2 * detail::component_size(position.format);
+    static constexpr std::size_t uv_size = 2 * detail::component_size(uv.format);
+    static constexpr std::size_t color_size = detail::color_size(color.format);
+
+    static_assert(std::is_standard_layout_v<Vertex> && std::is_trivially_copyable_v<Vertex>,
+                  "vertex types must be standard-layout and trivially copyable");
+    static_assert(position_size != 0, "position must use a scalar NK_FORMAT_*");
+    static_assert(uv_size != 0, "uv must use a scalar NK_FORMAT_*");
+    static_assert(color_size != 0, "color must be R8G8B8A8, B8G8R8A8, RGBA32 or R32G32B32A32_FLOAT");
+    static_assert(position.offset + position_size <= size, "position lies outside the vertex");
+    static_assert(uv.offset + uv_size <= size, "uv lies outside the vertex");
+    static_assert(color.offset + color_size <= size, "color lies outside the vertex");
+    static_assert(!detail::overlaps(position.offset, position_size, uv.offset, uv_size) &&
+                      !detail::overlaps(position.offset, position_size, color.offset, color_size) &&
+                      !detail::overlaps(uv.offset, uv_size, color.offset, color_size),
+                  "vertex attributes overlap");
+    static_assert(color.scale == 1.0f, "color cannot be scaled");
+
+    // scaleを使わないレイアウトはnk_convertにもそのまま渡せる
+    static constexpr bool nuklear_compatible = position.scale == 1.0f && uv.scale == 1.0f;
+    // vertexと同じレイアウト。カーネルが書いた頂点を詰め直さずにそのまま使える
+    static constexpr bool matches_vertex =
+        size == sizeof(vertex) && detail::same_attribute(position, vertex_format<vertex>::position) &&
+        detail::same_attribute(uv, vertex_format<vertex>::uv) &&
+        detail::same_attribute(color, vertex_format<vertex>::color);
+    static constexpr std::array<nk_draw_vertex_layout_element, 4> elements{{
+        {NK_VERTEX_POSITION, position.format, position.offset},
+        {NK_VERTEX_TEXCOORD, uv.format, uv.offset},
+        {NK_VERTEX_COLOR, color.format, color.offset},
+        {NK_VERTEX_LAYOUT_END},
+    }};
+
+    // vertexの値をこのレイアウトへ詰め直す。形式ごとの分岐はコンパイル時に決まる
+    static void pack(const vertex& in, Vertex& out) noexcept {
+        auto* dst = reinterpret_cast<std::byte*>(&out);
+        detail::write_components<position.format>(dst + position.offset, in.position[0] * position.scale,
+                                                  in.position[1] * position.scale);
+        detail::write_components<uv.format>(dst + uv.offset, in.uv[0] * uv.scale, in.uv[1] * uv.scale);
+        detail::write_color<color.format>(dst + color.offset, in.col);
+    }
+};
+
+} // namespace nk
@@ -0,0 +1,182 @@
+#include "nuklear-cpp/allocator.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <new>
+
+namespace nk {
+
+namespace {
+
+// 確保した領域の直前に置くサイズ情報の大きさ
+// Nuklearはmallocと同じアラインメントを期待するので、その分だけずらす
+constexpr std::size_t header_size = alignof(std::max_align_t);
+
+constexpr std::size_t align_up(std::size_t value, std::size_t alignment) noexcept {
+    return (value + alignment - 1) & ~(alignment - 1);
+}
+
+void* resource_alloc(nk_handle handle, void* /*old*/, nk_size size) {
+    auto* resource = static_cast<std::pmr::memory_resource*>(handle.ptr);
+    // C側に例外を流さず、確保失敗はnullptrで伝える
+    try {
+        auto* block = static_cast<std::byte*>(
+            resource->allocate(size + header_size, alignof(std::max_align_t)));
+        *reinterpret_cast<std::size_t*>(block) = size;
+        return block + header_size;
+    } catch (const std::bad_alloc&) {
+        return nullptr;
+    }
+}
+
+void resource_free(nk_handle handle, void* ptr) {
+    if (ptr == nullptr) {
+        return;
+    }
+    auto* resource = static_cast<std::pmr::memory_resource*>(handle.ptr);
+    auto* block = static_cast<std::byte*>(ptr) - header_size;
+    const std::size_t size = *reinterpret_cast<const std::size_t*>(block);
+    resource->deallocate(block, size + header_size, alignof(std::max_align_t));
+}
+
+} // namespace
+
+nk_allocator make_allocator(std::pmr::memory_resource& resource) noexcept {
+    nk_allocator allocator;
+    allocator.userdata = nk_handle_ptr(&resource);
+    allocator.alloc = resource_alloc;
+    allocator.free = resource_free;
+    return allocator;
+}
+
+frame_arena::frame_arena(std::size_t capacity, std::pmr::memory_resource* upstream)
+    : m_upstream(upstream),
+      m_buffer(static_cast<std::byte*>(upstream->allocate(capacity, alignof(std::max_align_t)))),
+      m_capacity(capacity) {}
+
+frame_arena::~frame_arena() {
+    release_overflow();
+    m_upstream->deallocate(m_buffer, m_capacity, alignof(std::max_align_t));
+}
+
+void frame_arena::reset() noexcept {
+    const bool overflowed = m_overflow != nullptr;
+    release_overflow();
+    m_used = 0;
+    // 溢れたフレームがあれば次からは最大使用量が一つの領域に収まるようにする
+    if (overflowed && m_high_water > m_capacity) {
+        try {
+            auto* buffer = static_cast<std::byte*>(
+                m_upstream->allocate(m_high_water, alignof(std::max_align_t)));
+            m_upstream->deallocate(m_buffer, m_capacity, alignof(std::max_align_t));
+            m_buffer = buffer;
+            m_capacity = m_high_water;
+        } catch (const std::bad_alloc&) {
+            // 容量を広げられなくても今までの領域で動作は続けられる
+        }
+    }
+}
+
+void* frame_arena::do_allocate(std::size_t bytes, std::size_t alignment) {
+    // 先頭のアラインメントより大きい要求もあるので、オフセットではなくアドレスを揃える
+    const auto base = reinterpret_cast<std::uintptr_t>(m_buffer);
+    const std::size_t offset = align_up(base + m_used, alignment) - base;
+    if (offset <= m_capacity && bytes <= m_capacity - offset) {
+        m_used = offset + bytes;
+        m_high_water = std::max(m_high_water, used());
+        return m_buffer + offset;
+    }
+
+    // 容量不足の分はupstreamから確保してリストで保持する
+    const std::size_t block_alignment = std::max(alignment, alignof(overflow_block));
+    const std::size_t header = align_up(sizeof(overflow_block), block_alignment);
+    auto* raw = static_cast<std::byte*>(m_upstream->allocate(header + bytes, block_alignment));
+    auto* block = reinterpret_cast<overflow_block*>(raw);
+    block->next = m_overflow;
+    block->bytes = header + bytes;
+    block->alignment = block_alignment;
+    m_overflow = block;
+    m_overflow_bytes += bytes;
+    ++m_overflow_count;
+    m_high_water = std::max(m_high_water, used());
+    return raw + header;
+}
+
+void frame_arena::do_deallocate(void* /*p*/, std::size_t /*bytes*/, std::size_t /*alignment*/) {
+    // 個別の解放は行わず、reset()でまとめて解放する
+}
+
+bool frame_arena::do_is_equal(const std::pmr::memory_resource& other) const noexcept {
+    return this == &other;
+}
+
+void frame_arena::release_overflow() noexcept {
+    while (m_overflow != nullptr) {
+        overflow_block* block = m_overflow;
+        m_overflow = block->next;
+        m_upstream->deallocate(block, block->bytes, block->alignment);
+    }
+    m_overflow_bytes = 0;
+}
+
+block_pool::block_pool(
+    std::size_t block_size, std::size_t blocks_per_chunk, std::pmr::memory_resource* upstream)
+    : m_upstream(upstream),
+      m_block_size(align_up(std::max(block_size, sizeof(free_block)), alignof(std::max_align_t))),
+      m_blocks_per_chunk(std::max<std::size_t>(blocks_per_chunk, 1)) {}
+
+block_pool::~block_pool() {
+    const std::size_t chunk_bytes = header_size + m_block_size * m_blocks_per_chunk;
+    while (m_chunks != nullptr) {
+        chunk* next = m_chunks->next;
+        m_upstream->deallocate(m_chunks, chunk_bytes, alignof(std::max_align_t));
+        m_chunks = next;
+    }
+}
+
+void* block_pool::do_allocate(std::size_t bytes, std::size_t alignment) {
+    if (bytes > m_block_size || alignment > alignof(std::max_align_t)) {
+        return m_upstream->allocate(bytes, alignment);
+    }
+    if (m_free == nullptr) {
+        add_chunk();
+    }
+    free_block* block = m_free;
+    m_free = block->next;
+    ++m_in_use;
+    return block;
+}
+
+void block_pool::do_deallocate(void* p, std::size_t bytes, std::size_t alignment) {
+    if (bytes > m_block_size || alignment > alignof(std::max_align_t)) {
+        m_upstream->deallocate(p, bytes, alignment);
+        return;
+    }
+    auto* block = static_cast<free_block*>(p);
+    block->next = m_free;
+    m_free = block;
+    --m_in_use;
+}
+
+bool block_pool::do_is_equal(const std::pmr::memory_resource& other) const noexcept {
+    return this == &other;
+}
+
+void block_pool::add_chunk() {
+    // チャンクの先頭にリストのリンクを置き、その後ろをブロックに切り分ける
+    const std::size_t chunk_bytes = header_size + m_block_size * m_blocks_per_chunk;
+    auto* raw = static_cast<std::byte*>(m_upstream->allocate(chunk_bytes, alignof(std::max_align_t)));
+    auto* new_chunk = reinterpret_cast<chunk*>(raw);
+    new_chunk->next = m_chunks;
+    m_chunks = new_chunk;
+
+    std::byte* blocks = raw + header_size;
+    for (std::size_t i = m_blocks_per_chunk; i-- > 0;) {
+        auto* block = reinterpret_cast<free_block*>(blocks + i * m_block_size);
+        block->next = m_free;
+        m_free = block;
+    }
+    m_reserved += m_blocks_per_chunk;
+}
+
+} // namespace nk
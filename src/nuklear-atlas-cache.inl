@@ -0,0 +1,355 @@
+// nuklear-impl.cppのNK_IMPLEMENTATIONの後で読み込む
+// ベイクを省いた時のフォントの初期化にnk_font_initを使うので単独ではコンパイルできない
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <vector>
+
+#if __has_include(<sys/mman.h>)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define NUKLEAR_CPP_ATLAS_MMAP 1
+#endif
+
+#include "nuklear-cpp/atlas_cache.hpp"
+
+namespace nk {
+
+namespace {
+
+// ファイルの形式を変えたら上げる
+constexpr std::uint32_t atlas_file_version = 1;
+// ベイクした画像とグリフの表はNuklearのベイクの処理で決まるので、その版もキーに含める
+// CMakeがFetchContentで固定したGIT_TAGを渡す
+#ifndef NUKLEAR_CPP_NUKLEAR_VERSION
+#define NUKLEAR_CPP_NUKLEAR_VERSION "unknown"
+#endif
+constexpr std::string_view atlas_nuklear_version = NUKLEAR_CPP_NUKLEAR_VERSION;
+constexpr char atlas_file_magic[4] = {'N', 'K', 'A', 'C'};
+// 画像はこの境界から置く
+constexpr std::size_t atlas_pixel_alignment = 64;
+
+static_assert(sizeof(nk_font_glyph) == 13 * 4, "nk_font_glyph is written as it is");
+
+struct atlas_file_header {
+    char magic[4];
+    std::uint32_t version;
+    std::uint64_t key;
+    std::uint32_t width;
+    std::uint32_t height;
+    std::uint32_t glyph_count;
+    std::uint32_t font_count;
+    std::int32_t custom[4];
+    std::uint32_t pixel_offset;
+    std::uint32_t reserved;
+};
+
+struct atlas_file_cursor {
+    std::uint16_t size[2];
+    std::uint16_t region[4];
+    float extent[2];
+    float offset[2];
+};
+
+struct atlas_file_font {
+    float height;
+    float ascent;
+    float descent;
+    std::uint32_t glyph_offset;
+    std::uint32_t glyph_count;
+};
+
+// FNV-1a
+std::uint64_t atlas_hash(std::uint64_t h, const void* data, std::size_t size) noexcept {
+    const auto* bytes = static_cast<const unsigned char*>(data);
+    for (std::size_t i = 0; i < size; ++i) {
+        h ^= bytes[i];
+        h *= 0x100000001b3ull;
+    }
+    return h;
+}
+
+template <class T>
+std::uint64_t atlas_hash_value(std::uint64_t h, const T& value) noexcept {
+    return atlas_hash(h, &value, sizeof(value));
+}
+
+// nk_font_bakeと同じ順(フォントごとに、結合されたフォントを含めて)に設定を辿る
+template <class F>
+void for_each_config(const nk_font_atlas& atlas, F f) {
+    for (const nk_font_config* first = atlas.config; first != nullptr; first = first->next) {
+        const nk_font_config* it = first;
+        do {
+            f(*it);
+            it = it->n;
+        } while (it != first);
+    }
+}
+
+std::size_t atlas_font_count(const nk_font_atlas& atlas) noexcept {
+    std::size_t count = 0;
+    for (const nk_font* font = atlas.fonts; font != nullptr; font = font->next) {
+        ++count;
+    }
+    return count;
+}
+
+std::size_t atlas_pixel_offset(std::size_t glyph_count, std::size_t font_count) noexcept {
+    const std::size_t tables = sizeof(atlas_file_header) + NK_CURSOR_COUNT * sizeof(atlas_file_cursor) +
+                               font_count * sizeof(atlas_file_font) + glyph_count * sizeof(nk_font_glyph);
+    return (tables + atlas_pixel_alignment - 1) & ~(atlas_pixel_alignment - 1);
+}
+
+std::string atlas_file_name(std::uint64_t key) {
+    char name[32];
+    std::snprintf(name, sizeof(name), "%016llx.nkatlas", static_cast<unsigned long long>(key));
+    return name;
+}
+
+// ベイク済みのatlasを書き込む。途中で失敗した時に壊れたファイルを残さないよう、
+// 一時ファイルに書いてから置き換える
+bool write_atlas(const std::filesystem::path& path, std::uint64_t key, const nk_font_atlas& atlas, int width,
+                 int height, const void* image) {
+    const std::size_t font_count = atlas_font_count(atlas);
+    const auto glyph_count = static_cast<std::size_t>(atlas.glyph_count);
+
+    atlas_file_header header{};
+    std::memcpy(header.magic, atlas_file_magic, sizeof(header.magic));
+    header.version = atlas_file_version;
+    header.key = key;
+    header.width = static_cast<std::uint32_t>(width);
+    header.height = static_cast<std::uint32_t>(height);
+    header.glyph_count = static_cast<std::uint32_t>(glyph_count);
+    header.font_count = static_cast<std::uint32_t>(font_count);
+    header.custom[0] = atlas.custom.x;
+    header.custom[1] = atlas.custom.y;
+    header.custom[2] = atlas.custom.w;
+    header.custom[3] = atlas.custom.h;
+    header.pixel_offset = static_cast<std::uint32_t>(atlas_pixel_offset(glyph_count, font_count));
+
+    std::vector<char> tables(header.pixel_offset);
+    char* out = tables.data();
+    std::memcpy(out, &header, sizeof(header));
+    out += sizeof(header);
+    for (const nk_cursor& cursor : atlas.cursors) {
+        const atlas_file_cursor c{{cursor.img.w, cursor.img.h},
+                                  {cursor.img.region[0], cursor.img.region[1], cursor.img.region[2],
+                                   cursor.img.region[3]},
+                                  {cursor.size.x, cursor.size.y},
+                                  {cursor.offset.x, cursor.offset.y}};
+        std::memcpy(out, &c, sizeof(c));
+        out += sizeof(c);
+    }
+    for (const nk_font* font = atlas.fonts; font != nullptr; font = font->next) {
+        const atlas_file_font f{font->info.height, font->info.ascent, font->info.descent, font->info.glyph_offset,
+                                font->info.glyph_count};
+        std::memcpy(out, &f, sizeof(f));
+        out += sizeof(f);
+    }
+    std::memcpy(out, atlas.glyphs, glyph_count * sizeof(nk_font_glyph));
+
+    std::error_code ec;
+    std::filesystem::create_directories(path.parent_path(), ec);
+    std::filesystem::path temporary = path;
+    temporary += ".tmp";
+    {
+        std::ofstream file(temporary, std::ios::binary | std::ios::trunc);
+        if (!file) {
+            return false;
+        }
+        file.write(tables.data(), static_cast<std::streamsize>(tables.size()));
+        file.write(static_cast<const char*>(image), static_cast<std::streamsize>(std::size_t(width) * height * 4));
+        if (!file) {
+            file.close();
+            std::filesystem::remove(temporary, ec);
+            return false;
+        }
+    }
+    std::filesystem::rename(temporary, path, ec);
+    if (ec) {
+        std::filesystem::remove(temporary, ec);
+        return false;
+    }
+    return true;
+}
+
+} // namespace
+
+// キャッシュファイルの中身。mmapが使えなければ読み込んだバッファを持つ
+struct atlas_cache::mapping {
+#ifdef NUKLEAR_CPP_ATLAS_MMAP
+    void* data = MAP_FAILED;
+    std::size_t size = 0;
+
+    explicit mapping(const std::filesystem::path& path) {
+        const int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0) {
+            return;
+        }
+        struct stat st;
+        if (::fstat(fd, &st) == 0 && st.st_size > 0) {
+            size = static_cast<std::size_t>(st.st_size);
+            data = ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+        }
+        ::close(fd);
+    }
+    ~mapping() {
+        if (data != MAP_FAILED) {
+            ::munmap(data, size);
+        }
+    }
+
+    const std::byte* bytes() const noexcept {
+        return data != MAP_FAILED ? static_cast<const std::byte*>(data) : nullptr;
+    }
+#else
+    std::vector<std::byte> buffer;
+    std::size_t size = 0;
+
+    explicit mapping(const std::filesystem::path& path) {
+        std::ifstream file(path, std::ios::binary | std::ios::ate);
+        if (!file) {
+            return;
+        }
+        buffer.resize(static_cast<std::size_t>(file.tellg()));
+        file.seekg(0);
+        if (file.read(reinterpret_cast<char*>(buffer.data()), static_cast<std::streamsize>(buffer.size()))) {
+            size = buffer.size();
+        }
+    }
+
+    const std::byte* bytes() const noexcept { return size != 0 ? buffer.data() : nullptr; }
+#endif
+
+    mapping(const mapping&) = delete;
+    mapping& operator=(const mapping&) = delete;
+};
+
+atlas_cache::atlas_cache(std::filesystem::path directory) : m_directory(std::move(directory)) {}
+
+atlas_cache::~atlas_cache() = default;
+
+std::uint64_t atlas_cache::key(const nk_font_atlas& atlas) noexcept {
+    std::uint64_t h = 0xcbf29ce484222325ull;
+    h = atlas_hash_value(h, atlas_file_version);
+    h = atlas_hash(h, atlas_nuklear_version.data(), atlas_nuklear_version.size());
+    h = atlas_hash_value(h, sizeof(nk_font_glyph));
+    h = atlas_hash_value(h, atlas.font_num);
+    for_each_config(atlas, [&](const nk_font_config& config) {
+        h = atlas_hash(h, config.ttf_blob, config.ttf_size);
+        h = atlas_hash_value(h, config.ttf_size);
+        h = atlas_hash_value(h, config.size);
+        h = atlas_hash_value(h, config.merge_mode);
+        h = atlas_hash_value(h, config.pixel_snap);
+        h = atlas_hash_value(h, config.oversample_v);
+        h = atlas_hash_value(h, config.oversample_h);
+        h = atlas_hash_value(h, config.coord_type);
+        h = atlas_hash_value(h, config.spacing.x);
+        h = atlas_hash_value(h, config.spacing.y);
+        h = atlas_hash_value(h, config.fallback_glyph);
+        // 範囲は0で終わる組の並び。nullptrならnk_font_default_glyph_ranges
+        const nk_rune* range = config.range != nullptr ? config.range : nk_font_default_glyph_ranges();
+        for (; range[0] != 0; range += 2) {
+            h = atlas_hash_value(h, range[0]);
+            h = atlas_hash_value(h, range[1]);
+        }
+    });
+    return h;
+}
+
+std::filesystem::path atlas_cache::path(std::uint64_t key) const {
+    return m_directory / atlas_file_name(key);
+}
+
+const void* atlas_cache::bake(nk_font_atlas* atlas, int* width, int* height) {
+    m_loaded = false;
+    m_mapping.reset();
+    // フォントがなければnk_font_atlas_bakeが既定のフォントを足すので、キャッシュは使わない
+    if (atlas->font_num == 0) {
+        return nk_font_atlas_bake(atlas, width, height, NK_FONT_ATLAS_RGBA32);
+    }
+
+    const std::uint64_t k = key(*atlas);
+    const std::filesystem::path file = path(k);
+    auto cached = std::make_unique<mapping>(file);
+    const std::byte* data = cached->bytes();
+
+    atlas_file_header header{};
+    if (data != nullptr && cached->size >= sizeof(header)) {
+        std::memcpy(&header, data, sizeof(header));
+    }
+    const std::size_t font_count = atlas_font_count(*atlas);
+    const bool valid =
+        std::memcmp(header.magic, atlas_file_magic, sizeof(header.magic)) == 0 &&
+        header.version == atlas_file_version && header.key == k && header.font_count == font_count &&
+        header.glyph_count != 0 && header.pixel_offset == atlas_pixel_offset(header.glyph_count, font_count) &&
+        cached->size == header.pixel_offset + std::size_t(header.width) * header.height * 4;
+    if (!valid) {
+        const void* image = nk_font_atlas_bake(atlas, width, height, NK_FONT_ATLAS_RGBA32);
+        if (image != nullptr) {
+            write_atlas(file, k, *atlas, *width, *height, image);
+        }
+        return image;
+    }
+
+    // nk_font_atlas_bakeがベイクの後に行う初期化をファイルの値で済ませる
+    const std::byte* in = data + sizeof(header);
+    for (nk_cursor& cursor : atlas->cursors) {
+        atlas_file_cursor c;
+        std::memcpy(&c, in, sizeof(c));
+        in += sizeof(c);
+        cursor.img.w = c.size[0];
+        cursor.img.h = c.size[1];
+        std::memcpy(cursor.img.region, c.region, sizeof(c.region));
+        cursor.size = nk_vec2(c.extent[0], c.extent[1]);
+        cursor.offset = nk_vec2(c.offset[0], c.offset[1]);
+    }
+    const std::byte* fonts = in;
+    in += font_count * sizeof(atlas_file_font);
+
+    const std::size_t glyph_bytes = header.glyph_count * sizeof(nk_font_glyph);
+    auto* glyphs = static_cast<nk_font_glyph*>(atlas->permanent.alloc(atlas->permanent.userdata, nullptr, glyph_bytes));
+    if (glyphs == nullptr) {
+        return nullptr;
+    }
+    std::memcpy(glyphs, in, glyph_bytes);
+    atlas->glyphs = glyphs;
+    atlas->glyph_count = static_cast<int>(header.glyph_count);
+    atlas->custom.x = static_cast<short>(header.custom[0]);
+    atlas->custom.y = static_cast<short>(header.custom[1]);
+    atlas->custom.w = static_cast<short>(header.custom[2]);
+    atlas->custom.h = static_cast<short>(header.custom[3]);
+    atlas->tex_width = static_cast<int>(header.width);
+    atlas->tex_height = static_cast<int>(header.height);
+    // 画像はマップした領域を指すので、nk_font_atlas_endに解放させない
+    atlas->pixel = nullptr;
+
+    for (nk_font* font = atlas->fonts; font != nullptr; font = font->next, fonts += sizeof(atlas_file_font)) {
+        atlas_file_font f;
+        std::memcpy(&f, fonts, sizeof(f));
+        nk_font_config* config = font->config;
+        nk_baked_font* baked = config->font;
+        baked->height = f.height;
+        baked->ascent = f.ascent;
+        baked->descent = f.descent;
+        baked->glyph_offset = f.glyph_offset;
+        baked->glyph_count = f.glyph_count;
+        baked->ranges = config->range != nullptr ? config->range : nk_font_default_glyph_ranges();
+        nk_font_init(font, config->size, config->fallback_glyph, atlas->glyphs, baked, nk_handle_ptr(nullptr));
+    }
+
+    *width = atlas->tex_width;
+    *height = atlas->tex_height;
+    m_mapping = std::move(cached);
+    m_loaded = true;
+    return data + header.pixel_offset;
+}
+
+} // namespace nk
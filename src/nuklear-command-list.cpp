@@ -0,0 +1,64 @@
+#include "nuklear-cpp/command_list.hpp"
+
+#include <cstring>
+
+namespace nk {
+
+std::size_t command_size(const nk_command* cmd) noexcept {
+    switch (cmd->type) {
+    case NK_COMMAND_SCISSOR: return sizeof(nk_command_scissor);
+    case NK_COMMAND_LINE: return sizeof(nk_command_line);
+    case NK_COMMAND_CURVE: return sizeof(nk_command_curve);
+    case NK_COMMAND_RECT: return sizeof(nk_command_rect);
+    case NK_COMMAND_RECT_FILLED: return sizeof(nk_command_rect_filled);
+    case NK_COMMAND_RECT_MULTI_COLOR: return sizeof(nk_command_rect_multi_color);
+    case NK_COMMAND_CIRCLE: return sizeof(nk_command_circle);
+    case NK_COMMAND_CIRCLE_FILLED: return sizeof(nk_command_circle_filled);
+    case NK_COMMAND_ARC: return sizeof(nk_command_arc);
+    case NK_COMMAND_ARC_FILLED: return sizeof(nk_command_arc_filled);
+    case NK_COMMAND_TRIANGLE: return sizeof(nk_command_triangle);
+    case NK_COMMAND_TRIANGLE_FILLED: return sizeof(nk_command_triangle_filled);
+    case NK_COMMAND_POLYGON:
+        return offsetof(nk_command_polygon, points)
+            + sizeof(struct nk_vec2i) * reinterpret_cast<const nk_command_polygon*>(cmd)->point_count;
+    case NK_COMMAND_POLYGON_FILLED:
+        return offsetof(nk_command_polygon_filled, points)
+            + sizeof(struct nk_vec2i) * reinterpret_cast<const nk_command_polygon_filled*>(cmd)->point_count;
+    case NK_COMMAND_POLYLINE:
+        return offsetof(nk_command_polyline, points)
+            + sizeof(struct nk_vec2i) * reinterpret_cast<const nk_command_polyline*>(cmd)->point_count;
+    case NK_COMMAND_TEXT:
+        // 終端の'\0'まで含める
+        return offsetof(nk_command_text, string)
+            + static_cast<std::size_t>(reinterpret_cast<const nk_command_text*>(cmd)->length) + 1;
+    case NK_COMMAND_IMAGE: return sizeof(nk_command_image);
+    case NK_COMMAND_CUSTOM: return sizeof(nk_command_custom);
+    default: return sizeof(nk_command);
+    }
+}
+
+void command_list::capture(nk_context* ctx) {
+    clear();
+    const nk_command* cmd = nullptr;
+    nk_foreach(cmd, ctx) {
+        append(cmd);
+    }
+}
+
+void command_list::clear() noexcept {
+    m_memory.clear();
+    m_offsets.clear();
+}
+
+void command_list::append(const nk_command* cmd) {
+    const std::size_t size = command_size(cmd);
+    const std::size_t offset = (m_memory.size() + alignment - 1) / alignment * alignment;
+    m_memory.resize(offset + size);
+    std::memcpy(m_memory.data() + offset, cmd, size);
+    // nextは元のバッファ内の位置なので、コピー先で次のコマンドが始まる位置に書き換える
+    auto* copy = reinterpret_cast<nk_command*>(m_memory.data() + offset);
+    copy->next = (offset + size + alignment - 1) / alignment * alignment;
+    m_offsets.push_back(offset);
+}
+
+} // namespace nk
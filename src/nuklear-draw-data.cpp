@@ -0,0 +1,510 @@
+#include "nuklear-cpp/draw_data.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+
+#include "nuklear-cpp/command_list.hpp"
+#include "nuklear-cpp/vertex_kernels.hpp"
+
+namespace nk {
+
+namespace {
+
+constexpr float pi = 3.141592654f;
+
+void init_buffer(nk_buffer& buffer, const nk_allocator* allocator) {
+    if (allocator != nullptr) {
+        nk_buffer_init(&buffer, allocator, NK_BUFFER_DEFAULT_INITIAL_SIZE);
+    } else {
+        nk_buffer_init_default(&buffer);
+    }
+}
+
+struct nk_vec2 point(short x, short y) noexcept {
+    return nk_vec2(static_cast<float>(x), static_cast<float>(y));
+}
+
+// nk_convertと同じ条件でバッファ不足を報告する
+nk_flags convert_result(const nk_buffer& cmds, const nk_buffer& vertices, const nk_buffer& elements) noexcept {
+    nk_flags result = NK_CONVERT_SUCCESS;
+    if (cmds.needed > cmds.allocated + (cmds.memory.size - cmds.size)) {
+        result |= NK_CONVERT_COMMAND_BUFFER_FULL;
+    }
+    if (vertices.needed > vertices.allocated) {
+        result |= NK_CONVERT_VERTEX_BUFFER_FULL;
+    }
+    if (elements.needed > elements.allocated) {
+        result |= NK_CONVERT_ELEMENT_BUFFER_FULL;
+    }
+    return result;
+}
+
+template <class Polygon>
+void path_points(nk_draw_list& list, const Polygon* p) {
+    for (int i = 0; i < p->point_count; ++i) {
+        nk_draw_list_path_line_to(&list, point(p->points[i].x, p->points[i].y));
+    }
+}
+
+// 分割数ごとの単位円上の点の表
+// max_segmentsまでの全ての分割数の表を最初に使った時にまとめて作り、以後は読むだけなので
+// 複数のスレッドから同時に使える
+class unit_circles {
+public:
+    static constexpr unsigned int max_segments = 64;
+
+    static const unit_circles& get() {
+        static const unit_circles instance;
+        return instance;
+    }
+
+    // 角度0から時計回り(y軸が下向き)にsegments個の点。segmentsは[1, max_segments]
+    const struct nk_vec2* points(unsigned int segments) const noexcept {
+        return m_points.data() + m_offsets[segments];
+    }
+
+private:
+    unit_circles() {
+        for (unsigned int n = 1; n <= max_segments; ++n) {
+            m_offsets[n] = m_points.size();
+            for (unsigned int i = 0; i < n; ++i) {
+                const float a = 2.0f * pi * static_cast<float>(i) / static_cast<float>(n);
+                m_points.push_back(nk_vec2(std::cos(a), std::sin(a)));
+            }
+        }
+    }
+
+    std::array<std::size_t, max_segments + 1> m_offsets{};
+    std::vector<struct nk_vec2> m_points;
+};
+
+// 半径radiusの円弧を弦と円の距離がtolerance以下になるよう分割した時の1区間の角度
+float segment_angle(float radius, float tolerance) noexcept {
+    if (radius <= tolerance) return pi;
+    return 2.0f * std::acos(1.0f - tolerance / radius);
+}
+
+unsigned int clamp_segments(float segments, unsigned int min, unsigned int limit) noexcept {
+    min = std::min(min, limit);
+    if (!(segments < static_cast<float>(limit))) return limit;
+    return std::max(min, static_cast<unsigned int>(std::ceil(segments)));
+}
+
+// nk_convertと同じく、属性ごとに形式を調べるNuklearの頂点書き込みを使う
+struct generic_shapes {
+    static void stroke_line(nk_draw_list& list, struct nk_vec2 a, struct nk_vec2 b, nk_color color,
+                            float thickness) {
+        nk_draw_list_stroke_line(&list, a, b, color, thickness);
+    }
+    static void stroke_curve(nk_draw_list& list, struct nk_vec2 p0, struct nk_vec2 cp0, struct nk_vec2 cp1,
+                             struct nk_vec2 p1, nk_color color, unsigned int segments, float thickness) {
+        nk_draw_list_stroke_curve(&list, p0, cp0, cp1, p1, color, segments, thickness);
+    }
+    static void stroke_rect(nk_draw_list& list, struct nk_rect rect, nk_color color, float rounding,
+                            float thickness) {
+        nk_draw_list_stroke_rect(&list, rect, color, rounding, thickness);
+    }
+    static void fill_rect(nk_draw_list& list, struct nk_rect rect, nk_color color, float rounding) {
+        nk_draw_list_fill_rect(&list, rect, color, rounding);
+    }
+    static void stroke_circle(nk_draw_list& list, struct nk_vec2 center, float radius, nk_color color,
+                              unsigned int segments, float thickness) {
+        nk_draw_list_stroke_circle(&list, center, radius, color, segments, thickness);
+    }
+    static void fill_circle(nk_draw_list& list, struct nk_vec2 center, float radius, nk_color color,
+                            unsigned int segments) {
+        nk_draw_list_fill_circle(&list, center, radius, color, segments);
+    }
+    static void stroke_triangle(nk_draw_list& list, struct nk_vec2 a, struct nk_vec2 b, struct nk_vec2 c,
+                                nk_color color, float thickness) {
+        nk_draw_list_stroke_triangle(&list, a, b, c, color, thickness);
+    }
+    static void fill_triangle(nk_draw_list& list, struct nk_vec2 a, struct nk_vec2 b, struct nk_vec2 c,
+                              nk_color color) {
+        nk_draw_list_fill_triangle(&list, a, b, c, color);
+    }
+    static void arc_to(nk_draw_list& list, struct nk_vec2 center, float radius, float a_min, float a_max,
+                       unsigned int segments) {
+        nk_draw_list_path_arc_to(&list, center, radius, a_min, a_max, segments);
+    }
+    static void path_stroke(nk_draw_list& list, nk_color color, nk_draw_list_stroke closed, float thickness) {
+        nk_draw_list_path_stroke(&list, color, closed, thickness);
+    }
+    static void path_fill(nk_draw_list& list, nk_color color) { nk_draw_list_path_fill(&list, color); }
+    static void add_text(nk_draw_list& list, const nk_user_font* font, struct nk_rect rect, const char* text,
+                         int len, float height, nk_color color) {
+        nk_draw_list_add_text(&list, font, rect, text, len, height, color);
+    }
+};
+
+// nk_draw_list_stroke_line等と同じパスを作り、vertexへ直接書き込むstroke_path/fill_pathで頂点にする
+// toleranceが正なら円・円弧・曲線・角丸の分割数を、画面上の誤差がtoleranceピクセル以下になる
+// 最小の数にする。設定の分割数(*_segment_count)はその上限になる
+// textsがあればテキストの頂点を文字列ごとに使い回す
+struct kernel_shapes {
+    float tolerance = 0.0f;
+    text_cache* texts = nullptr;
+
+    void stroke_line(nk_draw_list& list, struct nk_vec2 a, struct nk_vec2 b, nk_color color,
+                     float thickness) const {
+        if (!color.a) return;
+        if (list.line_AA != NK_ANTI_ALIASING_ON) {
+            a = nk_vec2(a.x - 0.5f, a.y - 0.5f);
+            b = nk_vec2(b.x - 0.5f, b.y - 0.5f);
+        }
+        nk_draw_list_path_line_to(&list, a);
+        nk_draw_list_path_line_to(&list, b);
+        stroke_path(list, color, NK_STROKE_OPEN, thickness);
+    }
+    void stroke_curve(nk_draw_list& list, struct nk_vec2 p0, struct nk_vec2 cp0, struct nk_vec2 cp1,
+                      struct nk_vec2 p1, nk_color color, unsigned int segments, float thickness) const {
+        if (!color.a) return;
+        if (tolerance > 0.0f) {
+            // 3次ベジェ曲線をn等分した折れ線の誤差は 2階差分の最大値 * 3/4 / n^2 以下
+            const float d0 = std::hypot(p0.x - 2.0f * cp0.x + cp1.x, p0.y - 2.0f * cp0.y + cp1.y);
+            const float d1 = std::hypot(cp0.x - 2.0f * cp1.x + p1.x, cp0.y - 2.0f * cp1.y + p1.y);
+            segments = clamp_segments(std::sqrt(0.75f * std::max(d0, d1) / tolerance), 1, segments);
+        }
+        nk_draw_list_path_line_to(&list, p0);
+        nk_draw_list_path_curve_to(&list, cp0, cp1, p1, segments);
+        stroke_path(list, color, NK_STROKE_OPEN, thickness);
+    }
+    void stroke_rect(nk_draw_list& list, struct nk_rect rect, nk_color color, float rounding,
+                     float thickness) const {
+        if (!color.a) return;
+        rect_to(list, rect, rounding);
+        stroke_path(list, color, NK_STROKE_CLOSED, thickness);
+    }
+    void fill_rect(nk_draw_list& list, struct nk_rect rect, nk_color color, float rounding) const {
+        if (!color.a) return;
+        rect_to(list, rect, rounding);
+        fill_path(list, color);
+    }
+    void stroke_circle(nk_draw_list& list, struct nk_vec2 center, float radius, nk_color color,
+                       unsigned int segments, float thickness) const {
+        if (!color.a) return;
+        circle_to(list, center, radius, segments);
+        stroke_path(list, color, NK_STROKE_CLOSED, thickness);
+    }
+    void fill_circle(nk_draw_list& list, struct nk_vec2 center, float radius, nk_color color,
+                     unsigned int segments) const {
+        if (!color.a) return;
+        circle_to(list, center, radius, segments);
+        fill_path(list, color);
+    }
+    void stroke_triangle(nk_draw_list& list, struct nk_vec2 a, struct nk_vec2 b, struct nk_vec2 c,
+                         nk_color color, float thickness) const {
+        if (!color.a) return;
+        triangle_to(list, a, b, c);
+        stroke_path(list, color, NK_STROKE_CLOSED, thickness);
+    }
+    void fill_triangle(nk_draw_list& list, struct nk_vec2 a, struct nk_vec2 b, struct nk_vec2 c,
+                       nk_color color) const {
+        if (!color.a) return;
+        triangle_to(list, a, b, c);
+        fill_path(list, color);
+    }
+    void arc_to(nk_draw_list& list, struct nk_vec2 center, float radius, float a_min, float a_max,
+                unsigned int segments) const {
+        if (tolerance > 0.0f) {
+            segments = clamp_segments(std::fabs(a_max - a_min) / segment_angle(radius, tolerance), 1, segments);
+        }
+        nk_draw_list_path_arc_to(&list, center, radius, a_min, a_max, segments);
+    }
+    void path_stroke(nk_draw_list& list, nk_color color, nk_draw_list_stroke closed, float thickness) const {
+        stroke_path(list, color, closed, thickness);
+    }
+    void path_fill(nk_draw_list& list, nk_color color) const { fill_path(list, color); }
+    void add_text(nk_draw_list& list, const nk_user_font* font, struct nk_rect rect, const char* text, int len,
+                  float height, nk_color color) const {
+        nk::add_text(list, font, rect, text, len, height, color, texts);
+    }
+
+private:
+    // アンチエイリアスなしの場合は左上を半ピクセルずらす
+    void rect_to(nk_draw_list& list, struct nk_rect rect, float rounding) const {
+        struct nk_vec2 a = nk_vec2(rect.x, rect.y);
+        const struct nk_vec2 b = nk_vec2(rect.x + rect.w, rect.y + rect.h);
+        if (list.line_AA != NK_ANTI_ALIASING_ON) {
+            a = nk_vec2(rect.x - 0.5f, rect.y - 0.5f);
+        }
+        const float r = std::min({rounding, std::fabs(b.x - a.x), std::fabs(b.y - a.y)});
+        if (tolerance <= 0.0f || r == 0.0f) {
+            nk_draw_list_path_rect_to(&list, a, b, rounding);
+            return;
+        }
+
+        // nk_draw_list_path_rect_toは角ごとに4点(12分割の円の1/4)を使う。小さな角はそれより減らす
+        const unsigned int quarter = clamp_segments(0.5f * pi / segment_angle(r, tolerance), 1, 3);
+        const struct nk_vec2* unit = unit_circles::get().points(quarter * 4);
+        const struct nk_vec2 centers[] = {
+            nk_vec2(a.x + r, a.y + r), nk_vec2(b.x - r, a.y + r), nk_vec2(b.x - r, b.y - r), nk_vec2(a.x + r, b.y - r),
+        };
+        // 左上の角は180度から始まる
+        for (unsigned int corner = 0; corner < 4; ++corner) {
+            const unsigned int first = ((corner + 2) % 4) * quarter;
+            for (unsigned int i = 0; i <= quarter; ++i) {
+                const struct nk_vec2 u = unit[(first + i) % (quarter * 4)];
+                nk_draw_list_path_line_to(&list, nk_vec2(centers[corner].x + u.x * r, centers[corner].y + u.y * r));
+            }
+        }
+    }
+    void circle_to(nk_draw_list& list, struct nk_vec2 center, float radius, unsigned int segments) const {
+        if (tolerance <= 0.0f) {
+            const float a_max = pi * 2.0f * (static_cast<float>(segments) - 1.0f) / static_cast<float>(segments);
+            nk_draw_list_path_arc_to(&list, center, radius, 0.0f, a_max, segments);
+            return;
+        }
+        if (radius == 0.0f) return;
+
+        // 閉じたパスとして描くので、始点に戻る点は置かない
+        segments = clamp_segments(2.0f * pi / segment_angle(radius, tolerance), 3, segments);
+        if (segments <= unit_circles::max_segments) {
+            const struct nk_vec2* unit = unit_circles::get().points(segments);
+            for (unsigned int i = 0; i < segments; ++i) {
+                nk_draw_list_path_line_to(&list, nk_vec2(center.x + unit[i].x * radius, center.y + unit[i].y * radius));
+            }
+        } else {
+            for (unsigned int i = 0; i < segments; ++i) {
+                const float a = 2.0f * pi * static_cast<float>(i) / static_cast<float>(segments);
+                nk_draw_list_path_line_to(&list, nk_vec2(center.x + std::cos(a) * radius, center.y + std::sin(a) * radius));
+            }
+        }
+    }
+    static void triangle_to(nk_draw_list& list, struct nk_vec2 a, struct nk_vec2 b, struct nk_vec2 c) {
+        nk_draw_list_path_line_to(&list, a);
+        nk_draw_list_path_line_to(&list, b);
+        nk_draw_list_path_line_to(&list, c);
+    }
+};
+
+// nk_convertのコマンドごとの処理と同じ
+template <class Shapes>
+void tessellate_command(const Shapes& shapes, nk_draw_list& list, const nk_command* cmd,
+                        const nk_convert_config& config) {
+    switch (cmd->type) {
+    case NK_COMMAND_NOP:
+        break;
+    case NK_COMMAND_SCISSOR: {
+        const auto* s = reinterpret_cast<const nk_command_scissor*>(cmd);
+        nk_draw_list_add_clip(&list, nk_rect(s->x, s->y, s->w, s->h));
+    } break;
+    case NK_COMMAND_LINE: {
+        const auto* l = reinterpret_cast<const nk_command_line*>(cmd);
+        shapes.stroke_line(list, point(l->begin.x, l->begin.y), point(l->end.x, l->end.y),
+                           l->color, l->line_thickness);
+    } break;
+    case NK_COMMAND_CURVE: {
+        const auto* q = reinterpret_cast<const nk_command_curve*>(cmd);
+        shapes.stroke_curve(list, point(q->begin.x, q->begin.y),
+                            point(q->ctrl[0].x, q->ctrl[0].y), point(q->ctrl[1].x, q->ctrl[1].y),
+                            point(q->end.x, q->end.y), q->color,
+                            config.curve_segment_count, q->line_thickness);
+    } break;
+    case NK_COMMAND_RECT: {
+        const auto* r = reinterpret_cast<const nk_command_rect*>(cmd);
+        shapes.stroke_rect(list, nk_rect(r->x, r->y, r->w, r->h), r->color,
+                           static_cast<float>(r->rounding), r->line_thickness);
+    } break;
+    case NK_COMMAND_RECT_FILLED: {
+        const auto* r = reinterpret_cast<const nk_command_rect_filled*>(cmd);
+        shapes.fill_rect(list, nk_rect(r->x, r->y, r->w, r->h), r->color,
+                         static_cast<float>(r->rounding));
+    } break;
+    case NK_COMMAND_RECT_MULTI_COLOR: {
+        const auto* r = reinterpret_cast<const nk_command_rect_multi_color*>(cmd);
+        nk_draw_list_fill_rect_multi_color(&list, nk_rect(r->x, r->y, r->w, r->h),
+                                           r->left, r->top, r->right, r->bottom);
+    } break;
+    case NK_COMMAND_CIRCLE: {
+        const auto* c = reinterpret_cast<const nk_command_circle*>(cmd);
+        shapes.stroke_circle(list, nk_vec2(c->x + c->w / 2.0f, c->y + c->h / 2.0f),
+                             c->w / 2.0f, c->color, config.circle_segment_count,
+                             c->line_thickness);
+    } break;
+    case NK_COMMAND_CIRCLE_FILLED: {
+        const auto* c = reinterpret_cast<const nk_command_circle_filled*>(cmd);
+        shapes.fill_circle(list, nk_vec2(c->x + c->w / 2.0f, c->y + c->h / 2.0f),
+                           c->w / 2.0f, c->color, config.circle_segment_count);
+    } break;
+    case NK_COMMAND_ARC: {
+        const auto* c = reinterpret_cast<const nk_command_arc*>(cmd);
+        nk_draw_list_path_line_to(&list, point(c->cx, c->cy));
+        shapes.arc_to(list, point(c->cx, c->cy), c->r, c->a[0], c->a[1], config.arc_segment_count);
+        shapes.path_stroke(list, c->color, NK_STROKE_CLOSED, c->line_thickness);
+    } break;
+    case NK_COMMAND_ARC_FILLED: {
+        const auto* c = reinterpret_cast<const nk_command_arc_filled*>(cmd);
+        nk_draw_list_path_line_to(&list, point(c->cx, c->cy));
+        shapes.arc_to(list, point(c->cx, c->cy), c->r, c->a[0], c->a[1], config.arc_segment_count);
+        shapes.path_fill(list, c->color);
+    } break;
+    case NK_COMMAND_TRIANGLE: {
+        const auto* t = reinterpret_cast<const nk_command_triangle*>(cmd);
+        shapes.stroke_triangle(list, point(t->a.x, t->a.y), point(t->b.x, t->b.y),
+                               point(t->c.x, t->c.y), t->color, t->line_thickness);
+    } break;
+    case NK_COMMAND_TRIANGLE_FILLED: {
+        const auto* t = reinterpret_cast<const nk_command_triangle_filled*>(cmd);
+        shapes.fill_triangle(list, point(t->a.x, t->a.y), point(t->b.x, t->b.y),
+                             point(t->c.x, t->c.y), t->color);
+    } break;
+    case NK_COMMAND_POLYGON: {
+        const auto* p = reinterpret_cast<const nk_command_polygon*>(cmd);
+        path_points(list, p);
+        shapes.path_stroke(list, p->color, NK_STROKE_CLOSED, p->line_thickness);
+    } break;
+    case NK_COMMAND_POLYGON_FILLED: {
+        const auto* p = reinterpret_cast<const nk_command_polygon_filled*>(cmd);
+        path_points(list, p);
+        shapes.path_fill(list, p->color);
+    } break;
+    case NK_COMMAND_POLYLINE: {
+        const auto* p = reinterpret_cast<const nk_command_polyline*>(cmd);
+        path_points(list, p);
+        shapes.path_stroke(list, p->color, NK_STROKE_OPEN, p->line_thickness);
+    } break;
+    case NK_COMMAND_TEXT: {
+        const auto* t = reinterpret_cast<const nk_command_text*>(cmd);
+        shapes.add_text(list, t->font, nk_rect(t->x, t->y, t->w, t->h), t->string, t->length, t->height,
+                        t->foreground);
+    } break;
+    case NK_COMMAND_IMAGE: {
+        const auto* i = reinterpret_cast<const nk_command_image*>(cmd);
+        nk_draw_list_add_image(&list, i->img, nk_rect(i->x, i->y, i->w, i->h), i->col);
+    } break;
+    case NK_COMMAND_CUSTOM: {
+        const auto* c = reinterpret_cast<const nk_command_custom*>(cmd);
+        c->callback(&list, c->x, c->y, c->w, c->h, c->callback_data);
+    } break;
+    default:
+        break;
+    }
+}
+
+} // namespace
+
+bool matches_vertex_layout(const nk_convert_config& config) noexcept {
+    using layout = vertex_layout<vertex>;
+    if (config.vertex_layout == layout::elements.data()) return true;
+    if (config.vertex_layout == nullptr || config.vertex_size != layout::size ||
+        config.vertex_alignment != layout::alignment) {
+        return false;
+    }
+    for (std::size_t i = 0; i < layout::elements.size(); ++i) {
+        const nk_draw_vertex_layout_element& expected = layout::elements[i];
+        const nk_draw_vertex_layout_element& actual = config.vertex_layout[i];
+        if (actual.attribute != expected.attribute) return false;
+        if (actual.attribute == NK_VERTEX_ATTRIBUTE_COUNT) break;
+        if (actual.format != expected.format || actual.offset != expected.offset) return false;
+    }
+    return true;
+}
+
+nk_convert_config make_convert_config(const convert_options& options) noexcept {
+    nk_convert_config config{};
+    config.vertex_layout = vertex_layout<vertex>::elements.data();
+    config.vertex_size = vertex_layout<vertex>::size;
+    config.vertex_alignment = vertex_layout<vertex>::alignment;
+    config.tex_null = options.tex_null;
+    config.circle_segment_count = options.circle_segments;
+    config.curve_segment_count = options.curve_segments;
+    config.arc_segment_count = options.arc_segments;
+    config.global_alpha = options.global_alpha;
+    config.shape_AA = options.anti_aliasing;
+    config.line_AA = options.anti_aliasing;
+    return config;
+}
+
+void tessellate(nk_draw_list& list, const nk_command* cmd, const nk_convert_config& config,
+                float segment_tolerance, text_cache* texts) {
+    if (matches_vertex_layout(config)) {
+        tessellate_command(kernel_shapes{segment_tolerance, texts}, list, cmd, config);
+    } else {
+        tessellate_command(generic_shapes{}, list, cmd, config);
+    }
+}
+
+nk_flags convert(nk_context* ctx, nk_buffer* cmds, nk_buffer* vertices, nk_buffer* elements,
+                 const nk_convert_config* config, float segment_tolerance, text_cache* texts) {
+    if (!ctx || !cmds || !vertices || !elements || !config || !config->vertex_layout) {
+        return NK_CONVERT_INVALID_PARAM;
+    }
+    if (!matches_vertex_layout(*config)) {
+        return nk_convert(ctx, cmds, vertices, elements, config);
+    }
+
+    nk_draw_list_setup(&ctx->draw_list, config, cmds, vertices, elements, config->line_AA, config->shape_AA);
+    const kernel_shapes shapes{segment_tolerance, texts};
+    const nk_command* cmd = nullptr;
+    nk_foreach(cmd, ctx) {
+        tessellate_command(shapes, ctx->draw_list, cmd, *config);
+    }
+    return convert_result(*cmds, *vertices, *elements);
+}
+
+converter::converter(const nk_allocator* allocator) {
+    init_buffer(m_commands, allocator);
+    init_buffer(m_vertices, allocator);
+    init_buffer(m_elements, allocator);
+}
+
+converter::~converter() {
+    nk_buffer_free(&m_commands);
+    nk_buffer_free(&m_vertices);
+    nk_buffer_free(&m_elements);
+}
+
+nk_flags converter::fill_buffers(nk_context* ctx, const convert_options& options) {
+    const nk_convert_config config = make_convert_config(options);
+    clear_buffers();
+    m_output = &ctx->draw_list;
+    if (options.cache_text) {
+        m_texts.next_frame();
+    }
+    return nk::convert(ctx, &m_commands, &m_vertices, &m_elements, &config, options.segment_tolerance,
+                       options.cache_text ? &m_texts : nullptr);
+}
+
+nk_flags converter::fill_buffers(const command_list& commands, const convert_options& options) {
+    if (options.cache_text) {
+        m_texts.next_frame();
+    }
+    return fill_buffers(commands, 0, commands.size(), options);
+}
+
+nk_flags converter::fill_buffers(const command_list& commands, std::size_t first, std::size_t last,
+                                 const convert_options& options) {
+    const nk_convert_config config = make_convert_config(options);
+    clear_buffers();
+    nk_draw_list_init(&m_list);
+    nk_draw_list_setup(&m_list, &config, &m_commands, &m_vertices, &m_elements,
+                       config.line_AA, config.shape_AA);
+    m_output = &m_list;
+    // make_convert_configのレイアウトは常にvertexなので専用の経路を使う
+    text_cache* texts = options.cache_text ? &m_texts : nullptr;
+    const kernel_shapes shapes{options.segment_tolerance, texts};
+    for (std::size_t i = first; i < last; ++i) {
+        tessellate_command(shapes, m_list, commands[i], config);
+    }
+    return convert_result(m_commands, m_vertices, m_elements);
+}
+
+void converter::clear_buffers() noexcept {
+    nk_buffer_clear(&m_commands);
+    nk_buffer_clear(&m_vertices);
+    nk_buffer_clear(&m_elements);
+}
+
+void converter::copy_elements(std::vector<nk_draw_index>& indices, std::vector<nk_draw_command>& commands) const {
+    const auto* first = static_cast<const nk_draw_index*>(nk_buffer_memory_const(&m_elements));
+    indices.assign(first, first + m_elements.allocated / sizeof(nk_draw_index));
+    commands.clear();
+    const nk_draw_command* cmd = nullptr;
+    nk_draw_list_foreach(cmd, m_output, &m_commands) {
+        commands.push_back(*cmd);
+    }
+}
+
+} // namespace nk
@@ -0,0 +1,98 @@
+#include "nuklear-cpp/frame_scheduler.hpp"
+
+#include <algorithm>
+#include <limits>
+
+namespace nk {
+
+frame_scheduler::frame_scheduler(const frame_waiter& waiter, int settle_frames)
+    : m_waiter(waiter), m_settle_frames(std::max(settle_frames, 0)) {}
+
+void frame_scheduler::wait() {
+    ++m_frames;
+    if (m_pending > 0) {
+        --m_pending;
+        return;
+    }
+    bool input = false;
+    for (;;) {
+        int timeout_ms = -1;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            if (m_requested) {
+                m_requested = false;
+                break;
+            }
+            if (m_deadline != clock::time_point::max()) {
+                const auto left = std::chrono::ceil<std::chrono::milliseconds>(m_deadline - clock::now()).count();
+                if (left <= 0) {
+                    m_deadline = clock::time_point::max();
+                    break;
+                }
+                timeout_ms = static_cast<int>(std::min<decltype(left)>(left, std::numeric_limits<int>::max()));
+            }
+            m_sleeping = true;
+        }
+        ++m_sleeps;
+        const bool woken = m_waiter.wait == nullptr || m_waiter.wait(m_waiter.userdata, timeout_ms);
+        bool requested = false;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_sleeping = false;
+            // request_frameのwakeで起きたのなら入力ではないので、落ち着くまで回す必要はない
+            requested = m_requested;
+            m_requested = false;
+        }
+        if (requested) {
+            break;
+        }
+        if (woken) {
+            input = true;
+            break;
+        }
+    }
+    // 入力の結果が落ち着くまで続けて回す。頼まれたフレームは1回で足りる
+    if (input) {
+        m_pending = m_settle_frames;
+    }
+}
+
+void frame_scheduler::frame_done(const nk_context* ctx) {
+    const nk_input& in = ctx->input;
+    bool held = in.mouse.grabbed != 0;
+    for (const nk_mouse_button& button : in.mouse.buttons) {
+        held = held || button.down != 0;
+    }
+    if (held) {
+        m_pending = std::max(m_pending, 1);
+    }
+}
+
+void frame_scheduler::request_frame() {
+    bool sleeping = false;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_requested = true;
+        sleeping = m_sleeping;
+    }
+    // 起きている時は次のwaitが見るので、余計なイベントを積まない
+    if (sleeping && m_waiter.wake != nullptr) {
+        m_waiter.wake(m_waiter.userdata);
+    }
+}
+
+void frame_scheduler::request_frame_in(std::chrono::milliseconds delay) {
+    bool wake = false;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        const clock::time_point deadline = clock::now() + delay;
+        // 眠っているwaitには、期限が早まった時だけ待ち直させる
+        wake = m_sleeping && deadline < m_deadline;
+        m_deadline = std::min(m_deadline, deadline);
+    }
+    if (wake && m_waiter.wake != nullptr) {
+        m_waiter.wake(m_waiter.userdata);
+    }
+}
+
+} // namespace nk
@@ -0,0 +1,302 @@
+// nuklear-impl.cppのNK_IMPLEMENTATIONの後で読み込む
+// Nuklearに組み込まれたstb_truetypeとnk_utf_decodeを使うので単独ではコンパイルできない
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <unordered_map>
+#include <vector>
+
+#include "nuklear-cpp/glyph_atlas.hpp"
+
+namespace nk {
+
+namespace {
+
+// 左上に置く白い画素の一辺
+constexpr int white_size = 2;
+// グリフの周りに空ける画素。線形補間で隣のグリフが滲まないようにする
+constexpr int glyph_padding = 1;
+
+std::uint32_t white_pixel(nk_byte alpha) noexcept {
+    const nk_color color{255, 255, 255, alpha};
+    std::uint32_t pixel;
+    std::memcpy(&pixel, &color, sizeof(pixel));
+    return pixel;
+}
+
+} // namespace
+
+struct glyph_atlas::glyph {
+    int index = 0;
+    float xadvance = 0.0f;
+    // 行の上端とペンの位置からのずれ
+    float x0 = 0.0f;
+    float y0 = 0.0f;
+    int w = 0;
+    int h = 0;
+    // 置いた行の番号。-1なら画素を持っていない
+    int shelf = -1;
+    int x = 0;
+    int y = 0;
+};
+
+struct glyph_atlas::face {
+    glyph_atlas* owner = nullptr;
+    std::vector<unsigned char> data;
+    stbtt_fontinfo info;
+    // stb_truetypeが作業領域の確保に使う
+    nk_allocator allocator;
+    float pixel_height = 0.0f;
+    float scale = 0.0f;
+    float ascent = 0.0f;
+    nk_user_font handle;
+    // ノードは再ハッシュでも動かないので、行はグリフへのポインタを持てる
+    std::unordered_map<nk_rune, glyph> glyphs;
+};
+
+glyph_atlas::glyph_atlas(int width, int height)
+    : m_width(width), m_height(height), m_pixels(static_cast<std::size_t>(width) * height, 0) {
+    for (int y = 0; y < white_size; ++y) {
+        std::fill_n(m_pixels.begin() + y * m_width, white_size, white_pixel(255));
+    }
+    // テクスチャの中身は不定なので最初に全体を送らせる
+    m_dirty = nk_recti{0, 0, static_cast<short>(width), static_cast<short>(height)};
+}
+
+glyph_atlas::~glyph_atlas() = default;
+
+nk_user_font* glyph_atlas::add_font(const void* ttf, std::size_t size, float pixel_height) {
+    auto f = std::make_unique<face>();
+    const auto* bytes = static_cast<const unsigned char*>(ttf);
+    f->data.assign(bytes, bytes + size);
+    const int offset = stbtt_GetFontOffsetForIndex(f->data.data(), 0);
+    if (offset < 0 || !stbtt_InitFont(&f->info, f->data.data(), offset)) {
+        return nullptr;
+    }
+    f->allocator.userdata = nk_handle_ptr(nullptr);
+    f->allocator.alloc = nk_malloc;
+    f->allocator.free = nk_mfree;
+    f->info.userdata = &f->allocator;
+
+    int ascent = 0;
+    int descent = 0;
+    int line_gap = 0;
+    stbtt_GetFontVMetrics(&f->info, &ascent, &descent, &line_gap);
+    f->owner = this;
+    f->pixel_height = pixel_height;
+    f->scale = stbtt_ScaleForPixelHeight(&f->info, pixel_height);
+    f->ascent = std::round(static_cast<float>(ascent) * f->scale);
+
+    f->handle.userdata = nk_handle_ptr(f.get());
+    f->handle.height = pixel_height;
+    f->handle.width = &glyph_atlas::text_width;
+    f->handle.query = &glyph_atlas::query;
+    f->handle.texture = m_texture;
+    m_faces.push_back(std::move(f));
+    return &m_faces.back()->handle;
+}
+
+nk_user_font* glyph_atlas::add_default_font(float pixel_height) {
+    // 圧縮されたProggyCleanの展開はnk_font_atlasに任せる
+    nk_font_atlas atlas;
+    nk_font_atlas_init_default(&atlas);
+    nk_font_atlas_begin(&atlas);
+    const nk_font* font = nk_font_atlas_add_default(&atlas, pixel_height, nullptr);
+    nk_user_font* result =
+        font != nullptr ? add_font(font->config->ttf_blob, font->config->ttf_size, pixel_height) : nullptr;
+    nk_font_atlas_clear(&atlas);
+    return result;
+}
+
+void glyph_atlas::set_texture(nk_handle texture) noexcept {
+    m_texture = texture;
+    for (const auto& f : m_faces) {
+        f->handle.texture = texture;
+    }
+}
+
+nk_vec2 glyph_atlas::white_uv() const noexcept {
+    return nk_vec2(0.5f * white_size / static_cast<float>(m_width), 0.5f * white_size / static_cast<float>(m_height));
+}
+
+const std::uint32_t* glyph_atlas::dirty_pixels() const noexcept {
+    return m_pixels.data() + static_cast<std::size_t>(m_dirty.y) * m_width + m_dirty.x;
+}
+
+bool glyph_atlas::next_frame() {
+    bool evicted = false;
+    if (m_missed_height > 0) {
+        // このフレームで使われず、入らなかったグリフを置ける行のうち最も古いものを空ける
+        // 1フレームに1行ずつなので、足りなければ次のフレームでまた空ける
+        shelf* oldest = nullptr;
+        for (shelf& s : m_shelves) {
+            if (s.last_used < m_frame && s.height >= m_missed_height && s.x > 0 &&
+                (oldest == nullptr || s.last_used < oldest->last_used)) {
+                oldest = &s;
+            }
+        }
+        if (oldest != nullptr) {
+            for (glyph* g : oldest->glyphs) {
+                g->shelf = -1;
+            }
+            m_glyph_count -= oldest->glyphs.size();
+            oldest->glyphs.clear();
+            oldest->x = 0;
+            ++m_evictions;
+            evicted = true;
+        }
+    }
+    m_missed_height = 0;
+    ++m_frame;
+    return evicted;
+}
+
+glyph_atlas::glyph& glyph_atlas::find(face& f, nk_rune codepoint) {
+    const auto [it, inserted] = f.glyphs.try_emplace(codepoint);
+    glyph& g = it->second;
+    if (inserted) {
+        // nk_font_atlasと同じく、フォントにない文字は'?'で描く
+        g.index = stbtt_FindGlyphIndex(&f.info, static_cast<int>(codepoint));
+        if (g.index == 0) {
+            g.index = stbtt_FindGlyphIndex(&f.info, '?');
+        }
+        int advance = 0;
+        int lsb = 0;
+        stbtt_GetGlyphHMetrics(&f.info, g.index, &advance, &lsb);
+        int x0 = 0;
+        int y0 = 0;
+        int x1 = 0;
+        int y1 = 0;
+        stbtt_GetGlyphBitmapBox(&f.info, g.index, f.scale, f.scale, &x0, &y0, &x1, &y1);
+        g.xadvance = static_cast<float>(advance) * f.scale;
+        g.x0 = static_cast<float>(x0);
+        g.y0 = static_cast<float>(y0) + f.ascent;
+        g.w = x1 - x0;
+        g.h = y1 - y0;
+    }
+    return g;
+}
+
+glyph_atlas::shelf* glyph_atlas::allocate(int w, int h) {
+    if (w > m_width) {
+        return nullptr;
+    }
+    // 高さが近い行を選び、なければ下に行を足す。足せなければ入る行のどれかに入れる
+    shelf* best = nullptr;
+    for (shelf& s : m_shelves) {
+        if (s.height >= h && s.x + w <= m_width && (best == nullptr || s.height < best->height)) {
+            best = &s;
+        }
+    }
+    if (best != nullptr && best->height <= h + h / 2) {
+        return best;
+    }
+    const int bottom = m_shelves.empty() ? white_size : m_shelves.back().y + m_shelves.back().height;
+    if (bottom + h <= m_height) {
+        m_shelves.push_back(shelf{bottom, h});
+        return &m_shelves.back();
+    }
+    return best;
+}
+
+bool glyph_atlas::rasterize(face& f, glyph& g) {
+    const int slot_w = g.w + 2 * glyph_padding;
+    const int slot_h = g.h + 2 * glyph_padding;
+    shelf* s = allocate(slot_w, slot_h);
+    if (s == nullptr) {
+        m_missed_height = std::max(m_missed_height, slot_h);
+        return false;
+    }
+    const int slot_x = s->x;
+    const int slot_y = s->y;
+    s->x += slot_w;
+    s->last_used = m_frame;
+    s->glyphs.push_back(&g);
+    g.shelf = static_cast<int>(s - m_shelves.data());
+    g.x = slot_x + glyph_padding;
+    g.y = slot_y + glyph_padding;
+    ++m_glyph_count;
+
+    // 空けた行には前のグリフが残っているので、余白ごと消してから描く
+    for (int y = 0; y < slot_h; ++y) {
+        std::fill_n(m_pixels.begin() + (slot_y + y) * m_width + slot_x, slot_w, 0u);
+    }
+    std::vector<unsigned char> alpha(static_cast<std::size_t>(g.w) * g.h);
+    stbtt_MakeGlyphBitmap(&f.info, alpha.data(), g.w, g.h, g.w, f.scale, f.scale, g.index);
+    for (int y = 0; y < g.h; ++y) {
+        std::uint32_t* row = m_pixels.data() + static_cast<std::size_t>(g.y + y) * m_width + g.x;
+        for (int x = 0; x < g.w; ++x) {
+            row[x] = white_pixel(alpha[static_cast<std::size_t>(y) * g.w + x]);
+        }
+    }
+    mark_dirty(slot_x, slot_y, slot_w, slot_h);
+    return true;
+}
+
+void glyph_atlas::mark_dirty(int x, int y, int w, int h) noexcept {
+    if (m_dirty.w > 0) {
+        const int x0 = std::min<int>(m_dirty.x, x);
+        const int y0 = std::min<int>(m_dirty.y, y);
+        const int x1 = std::max<int>(m_dirty.x + m_dirty.w, x + w);
+        const int y1 = std::max<int>(m_dirty.y + m_dirty.h, y + h);
+        x = x0;
+        y = y0;
+        w = x1 - x0;
+        h = y1 - y0;
+    }
+    m_dirty = nk_recti{static_cast<short>(x), static_cast<short>(y), static_cast<short>(w), static_cast<short>(h)};
+}
+
+// nk_font_text_widthと同じく、高さに合わせて送り幅を拡大縮小して足す
+// 幅を測るだけならラスタライズはしない
+float glyph_atlas::text_width(nk_handle handle, float height, const char* text, int len) {
+    auto* f = static_cast<face*>(handle.ptr);
+    if (text == nullptr || len == 0) {
+        return 0.0f;
+    }
+    float width = 0.0f;
+    nk_rune unicode = 0;
+    int glyph_len = nk_utf_decode(text, &unicode, len);
+    int text_len = glyph_len;
+    while (text_len <= len && glyph_len != 0) {
+        if (unicode == NK_UTF_INVALID) {
+            break;
+        }
+        width += f->owner->find(*f, unicode).xadvance;
+        glyph_len = nk_utf_decode(text + text_len, &unicode, len - text_len);
+        text_len += glyph_len;
+    }
+    return width * (height / f->pixel_height);
+}
+
+void glyph_atlas::query(nk_handle handle, float height, struct nk_user_font_glyph* out, nk_rune codepoint,
+                        nk_rune /*next_codepoint*/) {
+    auto* f = static_cast<face*>(handle.ptr);
+    glyph_atlas& atlas = *f->owner;
+    glyph& g = atlas.find(*f, codepoint);
+    if (g.shelf < 0 && g.w > 0 && g.h > 0) {
+        atlas.rasterize(*f, g);
+    }
+    const float scale = height / f->pixel_height;
+    out->xadvance = g.xadvance * scale;
+    if (g.shelf < 0) {
+        // 空白、または空きがなく描けなかったグリフ
+        out->width = 0.0f;
+        out->height = 0.0f;
+        out->offset = nk_vec2(0.0f, 0.0f);
+        out->uv[0] = atlas.white_uv();
+        out->uv[1] = atlas.white_uv();
+        return;
+    }
+    atlas.m_shelves[static_cast<std::size_t>(g.shelf)].last_used = atlas.m_frame;
+    const float inv_w = 1.0f / static_cast<float>(atlas.m_width);
+    const float inv_h = 1.0f / static_cast<float>(atlas.m_height);
+    out->width = static_cast<float>(g.w) * scale;
+    out->height = static_cast<float>(g.h) * scale;
+    out->offset = nk_vec2(g.x0 * scale, g.y0 * scale);
+    out->uv[0] = nk_vec2(static_cast<float>(g.x) * inv_w, static_cast<float>(g.y) * inv_h);
+    out->uv[1] = nk_vec2(static_cast<float>(g.x + g.w) * inv_w, static_cast<float>(g.y + g.h) * inv_h);
+}
+
+} // namespace nk
@@ -0,0 +1,320 @@
+#include "nuklear-cpp/headless.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <optional>
+#include <stdexcept>
+
+namespace nk {
+
+namespace {
+
+std::uint32_t pack(nk_color color) noexcept {
+    std::uint32_t pixel;
+    std::memcpy(&pixel, &color, sizeof(pixel));
+    return pixel;
+}
+
+nk_color unpack(std::uint32_t pixel) noexcept {
+    nk_color color;
+    std::memcpy(&color, &pixel, sizeof(color));
+    return color;
+}
+
+struct pixel_rect {
+    int x0, y0, x1, y1;
+};
+
+// クリップ矩形をフレームバッファ内の整数座標に丸める
+// Nuklearはクリップなしを(-8192,-8192,16384,16384)で表すので、先にfloatのままクランプする
+pixel_rect clip_to_target(const struct nk_rect& clip, const framebuffer& target) noexcept {
+    const float w = static_cast<float>(target.width());
+    const float h = static_cast<float>(target.height());
+    return {
+        static_cast<int>(std::floor(std::clamp(clip.x, 0.0f, w))),
+        static_cast<int>(std::floor(std::clamp(clip.y, 0.0f, h))),
+        static_cast<int>(std::ceil(std::clamp(clip.x + clip.w, 0.0f, w))),
+        static_cast<int>(std::ceil(std::clamp(clip.y + clip.h, 0.0f, h))),
+    };
+}
+
+float edge(const vertex& a, const vertex& b, float x, float y) noexcept {
+    return (b.position[0] - a.position[0]) * (y - a.position[1])
+         - (b.position[1] - a.position[1]) * (x - a.position[0]);
+}
+
+// 共有辺上の画素を片方の三角形だけが塗るための判定
+// 逆向きに辿る隣の三角形では必ず偽になる
+bool owns_edge(const vertex& a, const vertex& b) noexcept {
+    const float dx = b.position[0] - a.position[0];
+    const float dy = b.position[1] - a.position[1];
+    return dy < 0.0f || (dy == 0.0f && dx > 0.0f);
+}
+
+struct rgba {
+    float r, g, b, a;
+};
+
+rgba sample(const texture* tex, float u, float v) noexcept {
+    if (tex == nullptr || tex->width() == 0) {
+        return {1.0f, 1.0f, 1.0f, 1.0f};
+    }
+    const int x = std::clamp(static_cast<int>(u * tex->width()), 0, tex->width() - 1);
+    const int y = std::clamp(static_cast<int>(v * tex->height()), 0, tex->height() - 1);
+    const nk_color c = tex->color_at(x, y);
+    return {c.r / 255.0f, c.g / 255.0f, c.b / 255.0f, c.a / 255.0f};
+}
+
+// SDL_BLENDMODE_BLENDと同じ式で合成する
+void blend(std::uint32_t& dst, const rgba& src) noexcept {
+    if (src.a <= 0.0f) {
+        return;
+    }
+    const nk_color d = unpack(dst);
+    const float inv = 1.0f - src.a;
+    const nk_color out{
+        static_cast<nk_byte>(src.r * src.a * 255.0f + d.r * inv + 0.5f),
+        static_cast<nk_byte>(src.g * src.a * 255.0f + d.g * inv + 0.5f),
+        static_cast<nk_byte>(src.b * src.a * 255.0f + d.b * inv + 0.5f),
+        static_cast<nk_byte>(src.a * 255.0f + d.a * inv + 0.5f),
+    };
+    dst = pack(out);
+}
+
+void draw_triangle(const vertex& v0, const vertex& v1_in, const vertex& v2_in,
+                   const texture* tex, const pixel_rect& clip, framebuffer& target) noexcept {
+    const vertex* v1 = &v1_in;
+    const vertex* v2 = &v2_in;
+    float area = edge(v0, *v1, v2->position[0], v2->position[1]);
+    if (area == 0.0f) {
+        return;
+    }
+    if (area < 0.0f) {
+        std::swap(v1, v2);
+        area = -area;
+    }
+
+    const float min_x = std::min({v0.position[0], v1->position[0], v2->position[0]});
+    const float max_x = std::max({v0.position[0], v1->position[0], v2->position[0]});
+    const float min_y = std::min({v0.position[1], v1->position[1], v2->position[1]});
+    const float max_y = std::max({v0.position[1], v1->position[1], v2->position[1]});
+    const int x0 = std::max(clip.x0, static_cast<int>(std::floor(min_x)));
+    const int x1 = std::min(clip.x1, static_cast<int>(std::ceil(max_x)));
+    const int y0 = std::max(clip.y0, static_cast<int>(std::floor(min_y)));
+    const int y1 = std::min(clip.y1, static_cast<int>(std::ceil(max_y)));
+    if (x0 >= x1 || y0 >= y1) {
+        return;
+    }
+
+    const bool own0 = owns_edge(*v1, *v2);
+    const bool own1 = owns_edge(*v2, v0);
+    const bool own2 = owns_edge(v0, *v1);
+    // xが1進んだときの辺関数の増分
+    const float step0 = -(v2->position[1] - v1->position[1]);
+    const float step1 = -(v0.position[1] - v2->position[1]);
+    const float step2 = -(v1->position[1] - v0.position[1]);
+    const float inv_area = 1.0f / area;
+
+    const auto pixels = target.pixels();
+    for (int y = y0; y < y1; ++y) {
+        const float py = y + 0.5f;
+        const float px = x0 + 0.5f;
+        float w0 = edge(*v1, *v2, px, py);
+        float w1 = edge(*v2, v0, px, py);
+        float w2 = edge(v0, *v1, px, py);
+        std::uint32_t* row = pixels.data() + static_cast<std::size_t>(y) * target.width();
+        for (int x = x0; x < x1; ++x, w0 += step0, w1 += step1, w2 += step2) {
+            if (w0 < 0.0f || w1 < 0.0f || w2 < 0.0f) {
+                continue;
+            }
+            if ((w0 == 0.0f && !own0) || (w1 == 0.0f && !own1) || (w2 == 0.0f && !own2)) {
+                continue;
+            }
+            const float l0 = w0 * inv_area;
+            const float l1 = w1 * inv_area;
+            const float l2 = w2 * inv_area;
+            const float u = l0 * v0.uv[0] + l1 * v1->uv[0] + l2 * v2->uv[0];
+            const float v = l0 * v0.uv[1] + l1 * v1->uv[1] + l2 * v2->uv[1];
+            const rgba t = sample(tex, u, v);
+            const auto channel = [&](int i) {
+                return (l0 * v0.col[i] + l1 * v1->col[i] + l2 * v2->col[i]) / 255.0f;
+            };
+            blend(row[x], {channel(0) * t.r, channel(1) * t.g, channel(2) * t.b, channel(3) * t.a});
+        }
+    }
+}
+
+} // namespace
+
+texture::texture(int width, int height)
+    : m_width(width), m_height(height),
+      m_pixels(static_cast<std::size_t>(width) * height, 0) {}
+
+texture::texture(int width, int height, const void* rgba)
+    : texture(width, height) {
+    std::memcpy(m_pixels.data(), rgba, m_pixels.size() * sizeof(std::uint32_t));
+}
+
+nk_color texture::color_at(int x, int y) const noexcept {
+    return unpack(at(x, y));
+}
+
+void texture::clear(nk_color color) noexcept {
+    std::fill(m_pixels.begin(), m_pixels.end(), pack(color));
+}
+
+std::size_t texture::diff(const texture& other, int tolerance) const noexcept {
+    if (m_width != other.m_width || m_height != other.m_height) {
+        return std::max(m_pixels.size(), other.m_pixels.size());
+    }
+    std::size_t count = 0;
+    for (std::size_t i = 0; i < m_pixels.size(); ++i) {
+        if (m_pixels[i] == other.m_pixels[i]) {
+            continue;
+        }
+        const nk_color a = unpack(m_pixels[i]);
+        const nk_color b = unpack(other.m_pixels[i]);
+        if (std::abs(a.r - b.r) > tolerance || std::abs(a.g - b.g) > tolerance
+            || std::abs(a.b - b.b) > tolerance || std::abs(a.a - b.a) > tolerance) {
+            ++count;
+        }
+    }
+    return count;
+}
+
+bool texture::write_ppm(const char* path) const {
+    std::ofstream file(path, std::ios::binary);
+    if (!file) {
+        return false;
+    }
+    file << "P6\n" << m_width << ' ' << m_height << "\n255\n";
+    std::vector<char> rgb(m_pixels.size() * 3);
+    for (std::size_t i = 0; i < m_pixels.size(); ++i) {
+        const nk_color c = unpack(m_pixels[i]);
+        rgb[i * 3 + 0] = static_cast<char>(c.r);
+        rgb[i * 3 + 1] = static_cast<char>(c.g);
+        rgb[i * 3 + 2] = static_cast<char>(c.b);
+    }
+    file.write(rgb.data(), static_cast<std::streamsize>(rgb.size()));
+    return static_cast<bool>(file);
+}
+
+void rasterize(const draw_data& data, framebuffer& target) {
+    std::size_t offset = 0;
+    for (const nk_draw_command& cmd : data.commands) {
+        if (cmd.elem_count == 0) {
+            continue;
+        }
+        const pixel_rect clip = clip_to_target(cmd.clip_rect, target);
+        if (clip.x0 < clip.x1 && clip.y0 < clip.y1) {
+            const auto* tex = static_cast<const texture*>(cmd.texture.ptr);
+            for (std::size_t i = offset; i + 2 < offset + cmd.elem_count; i += 3) {
+                draw_triangle(data.vertices[data.indices[i]],
+                              data.vertices[data.indices[i + 1]],
+                              data.vertices[data.indices[i + 2]],
+                              tex, clip, target);
+            }
+        }
+        offset += cmd.elem_count;
+    }
+}
+
+headless_context::headless_context(int width, int height, float font_height,
+                                   const nk_allocator* allocator)
+    : m_converter(allocator), m_target(width, height) {
+    if (allocator != nullptr) {
+        nk_allocator atlas_allocator = *allocator;
+        nk_font_atlas_init(&m_atlas, &atlas_allocator);
+    } else {
+        nk_font_atlas_init_default(&m_atlas);
+    }
+    nk_font_atlas_begin(&m_atlas);
+    nk_font* font = nk_font_atlas_add_default(&m_atlas, font_height, nullptr);
+    int atlas_width = 0;
+    int atlas_height = 0;
+    const void* image = nk_font_atlas_bake(&m_atlas, &atlas_width, &atlas_height, NK_FONT_ATLAS_RGBA32);
+    if (font == nullptr || image == nullptr) {
+        nk_font_atlas_clear(&m_atlas);
+        throw std::runtime_error("nk::headless_context: failed to bake the default font");
+    }
+    m_font_texture = texture(atlas_width, atlas_height, image);
+    nk_font_atlas_end(&m_atlas, nk_handle_ptr(&m_font_texture), &m_options.tex_null);
+    m_font = &font->handle;
+
+    const nk_bool ok = allocator != nullptr ? nk_init(&m_ctx, allocator, m_font)
+                                            : nk_init_default(&m_ctx, m_font);
+    if (!ok) {
+        nk_font_atlas_clear(&m_atlas);
+        throw std::runtime_error("nk::headless_context: nk_init failed");
+    }
+}
+
+headless_context::~headless_context() {
+    nk_free(&m_ctx);
+    nk_font_atlas_clear(&m_atlas);
+}
+
+void headless_context::input_begin() {
+    if (m_profiler != nullptr) {
+        m_profiler->begin_frame();
+        m_profiler->start(profile_stage::input);
+    }
+    nk_input_begin(&m_ctx);
+}
+
+void headless_context::input_end() {
+    nk_input_end(&m_ctx);
+    if (m_profiler != nullptr) {
+        m_profiler->stop(profile_stage::input);
+        m_profiler->start(profile_stage::build);
+    }
+}
+
+nk_flags headless_context::convert() {
+    if (m_profiler == nullptr) {
+        return m_converter.convert(&m_ctx, m_options, m_data);
+    }
+    m_profiler->stop(profile_stage::build);
+    m_profiler->sample_context(&m_ctx);
+    nk_flags result;
+    {
+        profile_scope scope{*m_profiler, profile_stage::convert};
+        result = m_converter.convert(&m_ctx, m_options, m_data);
+    }
+    m_profiler->sample_draw_data(m_data);
+    return result;
+}
+
+void headless_context::submit() {
+    {
+        std::optional<profile_scope> scope;
+        if (m_profiler != nullptr) {
+            scope.emplace(*m_profiler, profile_stage::submit);
+        }
+        m_target.clear(m_clear_color);
+        rasterize(m_data, m_target);
+    }
+    nk_clear(&m_ctx);
+    if (m_profiler != nullptr) {
+        // ラスタライザはnk_draw_commandを1つずつ描き、クリップ矩形が変わる度に切り替える
+        std::uint64_t clip_changes = 0;
+        const nk_draw_command* previous = nullptr;
+        for (const nk_draw_command& cmd : m_data.commands) {
+            if (previous == nullptr || std::memcmp(&previous->clip_rect, &cmd.clip_rect, sizeof(cmd.clip_rect)) != 0) {
+                ++clip_changes;
+            }
+            previous = &cmd;
+        }
+        m_profiler->sample_submit(m_data.commands.size(), clip_changes);
+        m_profiler->end_frame();
+    }
+}
+
+void headless_context::render() {
+    convert();
+    submit();
+}
+
+} // namespace nk
@@ -2,3 +2,10 @@
 
 #define NK_IMPLEMENTATION
 #include "nuklear.h"
+
+// Nuklearの内部関数を使う頂点の書き込みは実装と同じ翻訳単位に置く
+#include "nuklear-vertex-kernels.inl"
+// ベイクを省いた時のフォントの初期化も内部関数を使う
+#include "nuklear-atlas-cache.inl"
+// 使われた時だけラスタライズするグリフのアトラスもstb_truetypeを使う
+#include "nuklear-glyph-atlas.inl"
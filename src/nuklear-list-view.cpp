@@ -0,0 +1,62 @@
+#include "nuklear-cpp/list_view.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+namespace nk {
+
+void row_heights::set(std::size_t row, float height) noexcept {
+    const double delta = static_cast<double>(height) - (m_tops[row + 1] - m_tops[row]);
+    for (std::size_t i = row + 1; i < m_tops.size(); ++i) {
+        m_tops[i] += delta;
+    }
+}
+
+visible_rows row_heights::visible(double offset, double view_height, float spacing) const noexcept {
+    const std::size_t count = size();
+    // 上端がoffset以下の最後の行から、上端がoffset + view_height未満の最後の行まで
+    const auto first_below = [&](double y) {
+        std::size_t lo = 0;
+        std::size_t hi = count;
+        while (lo < hi) {
+            const std::size_t mid = lo + (hi - lo) / 2;
+            if (top(mid, spacing) <= y) {
+                lo = mid + 1;
+            } else {
+                hi = mid;
+            }
+        }
+        return lo;
+    };
+    const std::size_t below = first_below(offset);
+    const std::size_t begin = below == 0 ? 0 : below - 1;
+    return {begin, std::max(begin, first_below(offset + view_height))};
+}
+
+namespace detail {
+
+visible_rows fixed_rows(std::size_t count, float row_height, float spacing, double offset,
+                        double view_height) noexcept {
+    const double stride = static_cast<double>(row_height) + spacing;
+    if (count == 0 || stride <= 0.0) {
+        return {};
+    }
+    const auto begin = std::min(count, static_cast<std::size_t>(std::max(0.0, offset) / stride));
+    const auto end =
+        std::min(count, static_cast<std::size_t>(std::ceil((std::max(0.0, offset) + view_height) / stride)));
+    return {begin, std::max(begin, end)};
+}
+
+void vertical_space(nk_context* ctx, double height) noexcept {
+    // 行の高さに行間が足されるので、その分を引いて1行の空白を置く
+    const double row = height - ctx->style.window.spacing.y;
+    if (row <= 0.0) {
+        return;
+    }
+    nk_layout_row_dynamic(ctx, static_cast<float>(row), 1);
+    nk_spacing(ctx, 1);
+}
+
+} // namespace detail
+
+} // namespace nk
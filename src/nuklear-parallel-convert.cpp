@@ -0,0 +1,116 @@
+#include "nuklear-cpp/parallel_convert.hpp"
+
+#include <algorithm>
+
+namespace nk {
+
+namespace {
+
+bool same_state(const nk_draw_command& a, const nk_draw_command& b) noexcept {
+    return a.texture.ptr == b.texture.ptr && a.clip_rect.x == b.clip_rect.x &&
+           a.clip_rect.y == b.clip_rect.y && a.clip_rect.w == b.clip_rect.w &&
+           a.clip_rect.h == b.clip_rect.h;
+}
+
+} // namespace
+
+parallel_converter::parallel_converter(thread_pool& pool, const nk_allocator* allocator) : m_pool(pool) {
+    m_converters.reserve(pool.size());
+    for (std::size_t i = 0; i < pool.size(); ++i) {
+        m_converters.push_back(std::make_unique<converter>(allocator));
+    }
+}
+
+parallel_converter::~parallel_converter() = default;
+
+// NK_COMMAND_SCISSORの位置で区切り、参加者数の4倍程度の区間になるようまとめる
+// 区間のdraw_dataは前のフレームのものを使い回す
+void parallel_converter::split(const command_list& commands) {
+    const std::size_t total = commands.size();
+    const std::size_t target = m_pool.size() * 4;
+    const std::size_t min_size = std::max(m_min_segment_commands, (total + target - 1) / target);
+
+    std::size_t count = 0;
+    std::size_t first = 0;
+    auto push = [&](std::size_t last) {
+        if (count == m_segments.size()) {
+            m_segments.emplace_back();
+        }
+        m_segments[count].first = first;
+        m_segments[count].last = last;
+        ++count;
+        first = last;
+    };
+    for (std::size_t i = 1; i < total; ++i) {
+        if (commands[i]->type == NK_COMMAND_SCISSOR && i - first >= min_size) {
+            push(i);
+        }
+    }
+    if (first < total) {
+        push(total);
+    }
+    m_segments.resize(count);
+}
+
+nk_flags parallel_converter::convert(const command_list& commands, const convert_options& options,
+                                     draw_data& out) {
+    // 参加者は1フレームにいくつもの区間を変換するので、テキストのキャッシュはここで1回だけ進める
+    if (options.cache_text) {
+        for (const auto& c : m_converters) {
+            c->texts().next_frame();
+        }
+    }
+    split(commands);
+    if (m_segments.size() <= 1) {
+        // 区切れない場合は呼び出し元のスレッドだけで変換する
+        m_segments.clear();
+        return m_converters.front()->convert(commands, 0, commands.size(), options, out);
+    }
+
+    m_pool.parallel_for(m_segments.size(), [&](std::size_t i, std::size_t participant) {
+        segment& s = m_segments[i];
+        s.result = m_converters[participant]->convert(commands, s.first, s.last, options, s.data);
+    });
+
+    // 区間ごとの書き込み位置を決める
+    nk_flags result = NK_CONVERT_SUCCESS;
+    std::size_t vertex_count = 0;
+    std::size_t index_count = 0;
+    for (segment& s : m_segments) {
+        s.vertex_offset = vertex_count;
+        s.index_offset = index_count;
+        vertex_count += s.data.vertices.size();
+        index_count += s.data.indices.size();
+        result |= s.result;
+    }
+    out.vertices.resize(vertex_count);
+    out.indices.resize(index_count);
+
+    // 頂点のコピーとインデックスの付け替えも区間ごとに並列で行う
+    m_pool.parallel_for(m_segments.size(), [&](std::size_t i, std::size_t) {
+        const segment& s = m_segments[i];
+        std::copy(s.data.vertices.begin(), s.data.vertices.end(), out.vertices.begin() + s.vertex_offset);
+        std::transform(s.data.indices.begin(), s.data.indices.end(), out.indices.begin() + s.index_offset,
+                       [base = s.vertex_offset](nk_draw_index index) {
+                           return static_cast<nk_draw_index>(index + base);
+                       });
+    });
+
+    // 空のコマンドを捨て、クリップ矩形とテクスチャが同じ隣り合うコマンドは1つにまとめる
+    out.commands.clear();
+    for (const segment& s : m_segments) {
+        for (const nk_draw_command& cmd : s.data.commands) {
+            if (cmd.elem_count == 0) {
+                continue;
+            }
+            if (!out.commands.empty() && same_state(out.commands.back(), cmd)) {
+                out.commands.back().elem_count += cmd.elem_count;
+            } else {
+                out.commands.push_back(cmd);
+            }
+        }
+    }
+    return result;
+}
+
+} // namespace nk
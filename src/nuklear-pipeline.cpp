@@ -0,0 +1,106 @@
+#include "nuklear-cpp/pipeline.hpp"
+
+#include <utility>
+
+namespace nk {
+
+convert_pipeline::convert_pipeline(const convert_options& options, std::size_t depth,
+                                   const nk_allocator* allocator)
+    : m_slots(depth == 0 ? 1 : depth), m_options(options), m_converter(allocator) {
+    m_worker = std::thread([this] { run(); });
+}
+
+convert_pipeline::~convert_pipeline() {
+    {
+        std::lock_guard lock{m_mutex};
+        m_stop = true;
+    }
+    m_work.notify_one();
+    m_worker.join();
+}
+
+void convert_pipeline::set_options(const convert_options& options) {
+    m_options = options;
+}
+
+void convert_pipeline::push(nk_context* ctx) {
+    std::size_t index;
+    {
+        std::unique_lock lock{m_mutex};
+        if (m_count == m_slots.size()) {
+            // 受け取り側が追いついていないので、最も古いフレームを捨てる
+            m_done.wait(lock, [this] { return m_converted > 0; });
+            m_head = (m_head + 1) % m_slots.size();
+            --m_count;
+            --m_converted;
+            ++m_dropped;
+        }
+        index = (m_head + m_count) % m_slots.size();
+    }
+
+    // このスロットはワーカーに渡すまで誰も触らないので、ロックの外でコピーする
+    slot& s = m_slots[index];
+    s.commands.capture(ctx);
+    s.options = m_options;
+    nk_clear(ctx);
+
+    {
+        std::lock_guard lock{m_mutex};
+        ++m_count;
+    }
+    m_work.notify_one();
+}
+
+bool convert_pipeline::pop(draw_data& out) {
+    std::unique_lock lock{m_mutex};
+    if (m_count == 0) {
+        return false;
+    }
+    m_done.wait(lock, [this] { return m_converted > 0; });
+    take(out);
+    return true;
+}
+
+bool convert_pipeline::try_pop(draw_data& out) {
+    std::lock_guard lock{m_mutex};
+    if (m_converted == 0) {
+        return false;
+    }
+    take(out);
+    return true;
+}
+
+std::size_t convert_pipeline::in_flight() const {
+    std::lock_guard lock{m_mutex};
+    return m_count;
+}
+
+std::size_t convert_pipeline::dropped() const {
+    std::lock_guard lock{m_mutex};
+    return m_dropped;
+}
+
+void convert_pipeline::take(draw_data& out) {
+    std::swap(out, m_slots[m_head].data);
+    m_head = (m_head + 1) % m_slots.size();
+    --m_count;
+    --m_converted;
+}
+
+void convert_pipeline::run() {
+    std::unique_lock lock{m_mutex};
+    for (;;) {
+        m_work.wait(lock, [this] { return m_stop || m_converted < m_count; });
+        if (m_stop) {
+            return;
+        }
+        slot& s = m_slots[(m_head + m_converted) % m_slots.size()];
+        lock.unlock();
+        m_converter.convert(s.commands, s.options, s.data);
+        lock.lock();
+        ++m_converted;
+        m_done.notify_all();
+    }
+}
+
+} // namespace nk
@@ -0,0 +1,62 @@
+#include "nuklear-cpp/profiler.hpp"
+
+#include <fstream>
+
+namespace nk {
+
+const char* to_string(profile_stage stage) noexcept {
+    switch (stage) {
+    case profile_stage::input: return "input";
+    case profile_stage::build: return "build";
+    case profile_stage::convert: return "convert";
+    case profile_stage::submit: return "submit";
+    case profile_stage::count: break;
+    }
+    return "unknown";
+}
+
+const char* to_string(profile_counter counter) noexcept {
+    switch (counter) {
+    case profile_counter::commands: return "commands";
+    case profile_counter::vertices: return "vertices";
+    case profile_counter::indices: return "indices";
+    case profile_counter::draw_calls: return "draw_calls";
+    case profile_counter::clip_changes: return "clip_changes";
+    case profile_counter::buffer_bytes: return "buffer_bytes";
+    case profile_counter::count: break;
+    }
+    return "unknown";
+}
+
+#if NUKLEAR_CPP_PROFILER
+
+bool profiler::dump(const char* path) const {
+    std::ofstream file(path);
+    if (!file) {
+        return false;
+    }
+    file << "frame";
+    for (std::size_t s = 0; s < profile_stage_count; ++s) {
+        file << ',' << to_string(static_cast<profile_stage>(s)) << "_ns";
+    }
+    for (std::size_t c = 0; c < profile_counter_count; ++c) {
+        file << ',' << to_string(static_cast<profile_counter>(c));
+    }
+    file << '\n';
+    for (std::size_t i = 0; i < size(); ++i) {
+        const frame_profile& f = (*this)[i];
+        file << f.frame;
+        for (const auto ns : f.stage_ns) {
+            file << ',' << ns;
+        }
+        for (const auto value : f.counters) {
+            file << ',' << value;
+        }
+        file << '\n';
+    }
+    return static_cast<bool>(file);
+}
+
+#endif
+
+} // namespace nk
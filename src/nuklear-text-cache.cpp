@@ -0,0 +1,110 @@
+#include "nuklear-cpp/text_cache.hpp"
+
+namespace nk {
+
+namespace {
+
+// 古いエントリを探すのはこの回数のnext_frameごと
+constexpr std::uint64_t sweep_interval = 16;
+
+// FNV-1a
+std::uint64_t hash_bytes(std::uint64_t h, const void* data, std::size_t size) noexcept {
+    const auto* bytes = static_cast<const unsigned char*>(data);
+    for (std::size_t i = 0; i < size; ++i) {
+        h ^= bytes[i];
+        h *= 0x100000001b3ull;
+    }
+    return h;
+}
+
+std::uint64_t hash_text(std::string_view text, float height) noexcept {
+    std::uint64_t h = hash_bytes(0xcbf29ce484222325ull, text.data(), text.size());
+    return hash_bytes(h, &height, sizeof(height));
+}
+
+std::uint64_t hash_run(std::string_view text, const nk_user_font* font, float height, nk_color color) noexcept {
+    std::uint64_t h = hash_text(text, height);
+    h = hash_bytes(h, &font, sizeof(font));
+    return hash_bytes(h, &color, sizeof(color));
+}
+
+bool same_color(nk_color a, nk_color b) noexcept {
+    return a.r == b.r && a.g == b.g && a.b == b.b && a.a == b.a;
+}
+
+template <class Map>
+void erase_older(Map& map, std::uint64_t frame, std::uint64_t max_age) {
+    if (frame % sweep_interval != 0) return;
+    std::erase_if(map, [&](const auto& kv) { return frame - kv.second.last_used > max_age; });
+}
+
+} // namespace
+
+const text_cache::run* text_cache::find(std::string_view text, const nk_user_font* font, float height,
+                                        nk_color color) noexcept {
+    const auto it = m_runs.find(hash_run(text, font, height, color));
+    if (it == m_runs.end() || it->second.font != font || it->second.height != height ||
+        !same_color(it->second.color, color) || it->second.text != text) {
+        ++m_misses;
+        return nullptr;
+    }
+    ++m_hits;
+    it->second.last_used = m_frame;
+    return &it->second;
+}
+
+text_cache::run& text_cache::insert(std::string_view text, const nk_user_font* font, float height,
+                                    nk_color color) {
+    run& r = m_runs[hash_run(text, font, height, color)];
+    r.text.assign(text);
+    r.font = font;
+    r.height = height;
+    r.color = color;
+    r.vertices.clear();
+    r.last_used = m_frame;
+    return r;
+}
+
+void text_cache::next_frame() {
+    ++m_frame;
+    erase_older(m_runs, m_frame, m_max_age);
+    m_hits = 0;
+    m_misses = 0;
+}
+
+void text_cache::clear() noexcept {
+    m_runs.clear();
+}
+
+cached_font::cached_font(const nk_user_font& base, std::uint64_t max_age)
+    : m_base(base), m_font(base), m_max_age(max_age) {
+    m_font.userdata = nk_handle_ptr(this);
+    m_font.width = &cached_font::width;
+    m_font.query = &cached_font::query;
+}
+
+void cached_font::next_frame() {
+    ++m_frame;
+    erase_older(m_widths, m_frame, m_max_age);
+}
+
+float cached_font::width(nk_handle handle, float height, const char* text, int len) {
+    auto* self = static_cast<cached_font*>(handle.ptr);
+    const std::string_view key(text, static_cast<std::size_t>(len));
+    entry& e = self->m_widths[hash_text(key, height)];
+    if (e.height != height || e.text != key || e.text.empty()) {
+        e.text.assign(key);
+        e.height = height;
+        e.width = self->m_base.width(self->m_base.userdata, height, text, len);
+    }
+    e.last_used = self->m_frame;
+    return e.width;
+}
+
+void cached_font::query(nk_handle handle, float height, struct nk_user_font_glyph* glyph, nk_rune codepoint,
+                        nk_rune next_codepoint) {
+    const auto* self = static_cast<const cached_font*>(handle.ptr);
+    self->m_base.query(self->m_base.userdata, height, glyph, codepoint, next_codepoint);
+}
+
+} // namespace nk
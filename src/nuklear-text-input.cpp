@@ -0,0 +1,133 @@
+#include "nuklear-cpp/text_input.hpp"
+
+#include <algorithm>
+
+namespace nk {
+
+namespace {
+
+bool is_continuation(char c) noexcept {
+    return (static_cast<unsigned char>(c) & 0xc0) == 0x80;
+}
+
+// text[0, size)の中で、UTF-8の文字の途中で切れない最も長い位置
+std::size_t utf8_prefix(std::string_view text, std::size_t size) noexcept {
+    if (size >= text.size()) {
+        return text.size();
+    }
+    std::size_t end = size;
+    while (end > 0 && is_continuation(text[end])) {
+        --end;
+    }
+    // 1文字がsizeより長ければその1文字だけ進める
+    if (end == 0) {
+        end = 1;
+        while (end < text.size() && is_continuation(text[end])) {
+            ++end;
+        }
+    }
+    return end;
+}
+
+} // namespace
+
+text_input::text_input(const clipboard_backend& backend, std::size_t paste_chunk)
+    : m_backend(backend), m_paste_chunk(std::max<std::size_t>(paste_chunk, 1)) {}
+
+text_input::~text_input() {
+    cancel_paste();
+}
+
+void text_input::install(nk_context* ctx) noexcept {
+    ctx->clip.userdata = nk_handle_ptr(this);
+    ctx->clip.copy = &text_input::copy;
+    ctx->clip.paste = &text_input::paste;
+}
+
+void text_input::feed(std::string_view utf8) {
+    // 渡し終えた部分は次に積む時に詰める
+    if (m_text_offset == m_text.size()) {
+        m_text.clear();
+        m_text_offset = 0;
+    }
+    m_text.append(utf8);
+}
+
+void text_input::update(nk_context* ctx) {
+    // 送った貼り付けキーを誰も受け取らなかったのは、編集欄が閉じたかフォーカスを失ったから
+    if (m_paste_requested) {
+        cancel_paste();
+    }
+    if (pasting()) {
+        // 押して離すとnk_input_is_key_pressedが1回分の押下と見なす
+        nk_input_key(ctx, NK_KEY_PASTE, nk_true);
+        nk_input_key(ctx, NK_KEY_PASTE, nk_false);
+        m_paste_requested = true;
+    }
+
+    while (m_text_offset < m_text.size()) {
+        nk_rune unicode = 0;
+        const char* text = m_text.data() + m_text_offset;
+        const int len = nk_utf_decode(text, &unicode, static_cast<int>(m_text.size() - m_text_offset));
+        if (len == 0 || unicode == NK_UTF_INVALID) {
+            // 壊れた並びは捨てる
+            m_text_offset = m_text.size();
+            break;
+        }
+        // nk_input_glyphはtext_len + len < NK_INPUT_MAXの時だけ受け取り、入らなければ黙って捨てる
+        if (ctx->input.keyboard.text_len + len >= NK_INPUT_MAX) {
+            break;
+        }
+        nk_input_unicode(ctx, unicode);
+        m_text_offset += static_cast<std::size_t>(len);
+    }
+}
+
+void text_input::cancel_paste() noexcept {
+    if (!m_paste_source.empty() && m_backend.release != nullptr) {
+        m_backend.release(m_backend.userdata, m_paste_source);
+    }
+    m_paste_source = {};
+    m_paste = {};
+    m_paste_requested = false;
+}
+
+void text_input::copy(nk_handle handle, const char* text, int len) {
+    auto* self = static_cast<text_input*>(handle.ptr);
+    if (self->m_backend.set == nullptr || len <= 0) {
+        return;
+    }
+    self->m_scratch.assign(text, static_cast<std::size_t>(len));
+    self->m_backend.set(self->m_backend.userdata, self->m_scratch.c_str());
+}
+
+void text_input::paste(nk_handle handle, nk_text_edit* edit) {
+    auto* self = static_cast<text_input*>(handle.ptr);
+    self->m_paste_requested = false;
+    if (self->m_paste.empty()) {
+        if (self->m_backend.get == nullptr) {
+            return;
+        }
+        const std::string_view text = self->m_backend.get(self->m_backend.userdata);
+        if (text.empty()) {
+            if (text.data() != nullptr && self->m_backend.release != nullptr) {
+                self->m_backend.release(self->m_backend.userdata, text);
+            }
+            return;
+        }
+        self->m_paste_source = text;
+        self->m_paste = text;
+    }
+    const std::size_t size = utf8_prefix(self->m_paste, self->m_paste_chunk);
+    // 固定長の編集欄が一杯になったら残りは入らない
+    if (!nk_textedit_paste(edit, self->m_paste.data(), static_cast<int>(size))) {
+        self->cancel_paste();
+        return;
+    }
+    self->m_paste.remove_prefix(size);
+    if (self->m_paste.empty()) {
+        self->cancel_paste();
+    }
+}
+
+} // namespace nk
@@ -0,0 +1,50 @@
+#include "nuklear-cpp/theme.hpp"
+
+#include <algorithm>
+#include <iterator>
+
+namespace nk {
+
+namespace {
+
+// フォントとカーソルはテーマに含めず、書き込み先のものを残す
+void copy_colors(nk_style& dst, const nk_style& src) noexcept {
+    const nk_user_font* font = dst.font;
+    const nk_cursor* cursors[NK_CURSOR_COUNT];
+    std::copy(std::begin(dst.cursors), std::end(dst.cursors), cursors);
+    const nk_cursor* cursor_active = dst.cursor_active;
+    nk_cursor* cursor_last = dst.cursor_last;
+    const int cursor_visible = dst.cursor_visible;
+
+    dst = src;
+
+    dst.font = font;
+    std::copy(std::begin(cursors), std::end(cursors), dst.cursors);
+    dst.cursor_active = cursor_active;
+    dst.cursor_last = cursor_last;
+    dst.cursor_visible = cursor_visible;
+}
+
+} // namespace
+
+theme::theme(nk_context* ctx, const color_table& colors) : m_colors(colors), m_style{} {
+    const nk_style saved = ctx->style;
+    nk_style_from_table(ctx, m_colors.data());
+    m_style = ctx->style;
+    ctx->style = saved;
+}
+
+void theme::apply(nk_context* ctx) const noexcept {
+    copy_colors(ctx->style, m_style);
+}
+
+theme_scope::theme_scope(nk_context* ctx, const theme& t) noexcept : m_ctx(ctx), m_saved(ctx->style) {
+    t.apply(ctx);
+}
+
+// スコープの中で変わったフォントやカーソル(nk_style_set_font等)はそのまま残し、色だけを戻す
+theme_scope::~theme_scope() {
+    copy_colors(m_ctx->style, m_saved);
+}
+
+} // namespace nk
@@ -0,0 +1,120 @@
+#include "nuklear-cpp/thread_pool.hpp"
+
+namespace nk {
+
+thread_pool::thread_pool(std::size_t threads) {
+    const std::size_t count = threads == 0 ? 1 : threads;
+    m_queues.reserve(count);
+    for (std::size_t i = 0; i < count; ++i) {
+        m_queues.push_back(std::make_unique<queue>());
+    }
+    m_threads.reserve(count - 1);
+    for (std::size_t i = 1; i < count; ++i) {
+        m_threads.emplace_back([this, i] { worker(i); });
+    }
+}
+
+thread_pool::~thread_pool() {
+    {
+        std::lock_guard lock{m_mutex};
+        m_stop = true;
+    }
+    m_start.notify_all();
+    for (auto& thread : m_threads) {
+        thread.join();
+    }
+}
+
+void thread_pool::parallel_for(std::size_t count, const std::function<void(std::size_t, std::size_t)>& fn) {
+    if (count == 0) {
+        return;
+    }
+    if (m_queues.size() == 1) {
+        for (std::size_t i = 0; i < count; ++i) {
+            fn(i, 0);
+        }
+        return;
+    }
+
+    // 前回のparallel_forの残りを探している参加者が新しい添字を拾うこともあるので、
+    // 添字を配る前にfnを公開しておく
+    {
+        std::lock_guard lock{m_mutex};
+        m_job = &fn;
+    }
+    m_pending.store(count, std::memory_order_relaxed);
+
+    // 近い添字が同じ参加者に行くように、連続した範囲で配る
+    const std::size_t participants = m_queues.size();
+    for (std::size_t p = 0; p < participants; ++p) {
+        const std::size_t first = count * p / participants;
+        const std::size_t last = count * (p + 1) / participants;
+        std::lock_guard lock{m_queues[p]->mutex};
+        for (std::size_t i = first; i < last; ++i) {
+            m_queues[p]->tasks.push_back(i);
+        }
+    }
+    {
+        std::lock_guard lock{m_mutex};
+        ++m_generation;
+    }
+    m_start.notify_all();
+
+    drain(0);
+
+    std::unique_lock lock{m_mutex};
+    m_finish.wait(lock, [this] { return m_pending.load(std::memory_order_acquire) == 0; });
+    m_job = nullptr;
+}
+
+void thread_pool::worker(std::size_t participant) {
+    std::size_t seen = 0;
+    for (;;) {
+        {
+            std::unique_lock lock{m_mutex};
+            m_start.wait(lock, [&] { return m_stop || m_generation != seen; });
+            if (m_stop) {
+                return;
+            }
+            seen = m_generation;
+        }
+        drain(participant);
+    }
+}
+
+void thread_pool::drain(std::size_t participant) {
+    std::size_t task;
+    while (pop(participant, task)) {
+        (*m_job)(task, participant);
+        if (m_pending.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+            std::lock_guard lock{m_mutex};
+            m_finish.notify_all();
+        }
+    }
+}
+
+bool thread_pool::pop(std::size_t participant, std::size_t& task) {
+    // 自分の範囲は末尾から取る
+    {
+        queue& own = *m_queues[participant];
+        std::lock_guard lock{own.mutex};
+        if (!own.tasks.empty()) {
+            task = own.tasks.back();
+            own.tasks.pop_back();
+            return true;
+        }
+    }
+    // 他の参加者の範囲は先頭から奪う
+    for (std::size_t i = 1; i < m_queues.size(); ++i) {
+        queue& victim = *m_queues[(participant + i) % m_queues.size()];
+        std::lock_guard lock{victim.mutex};
+        if (!victim.tasks.empty()) {
+            task = victim.tasks.front();
+            victim.tasks.pop_front();
+            return true;
+        }
+    }
+    return false;
+}
+
+} // namespace nk
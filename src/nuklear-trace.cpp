@@ -0,0 +1,308 @@
+#include "nuklear-cpp/trace.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+namespace nk {
+
+namespace {
+
+// ファイルの形式を変えたら上げる
+constexpr std::uint32_t trace_version = 1;
+constexpr char trace_magic[4] = {'N', 'K', 'T', 'R'};
+
+// チャンクの種類。チャンクは[tag:u32][size:u32][size バイトの中身]の順に並ぶ
+enum class chunk : std::uint32_t {
+    font = 1,
+    frame = 2,
+};
+
+// フレームの中身の中でコマンドを置く境界。読み込んだバッファからそのまま参照できるようにする
+constexpr std::size_t command_alignment = alignof(std::max_align_t);
+
+// チャンクの中身の最大値。壊れたファイルで巨大な確保をしないようにする
+constexpr std::uint32_t max_chunk_size = 1u << 30;
+
+std::size_t align_up(std::size_t value) noexcept {
+    return (value + command_alignment - 1) / command_alignment * command_alignment;
+}
+
+template <class T>
+void put(std::vector<std::byte>& out, const T& value) {
+    const auto* bytes = reinterpret_cast<const std::byte*>(&value);
+    out.insert(out.end(), bytes, bytes + sizeof(value));
+}
+
+void put_bytes(std::vector<std::byte>& out, const void* data, std::size_t size) {
+    const auto* bytes = static_cast<const std::byte*>(data);
+    out.insert(out.end(), bytes, bytes + size);
+}
+
+// 読み込み位置を進めながら取り出す。足りなければokをfalseにする
+class cursor {
+public:
+    cursor(const std::byte* data, std::size_t size) noexcept : m_data(data), m_size(size) {}
+
+    template <class T>
+    T get() noexcept {
+        T value{};
+        if (m_offset + sizeof(value) > m_size) {
+            m_ok = false;
+            return value;
+        }
+        std::memcpy(&value, m_data + m_offset, sizeof(value));
+        m_offset += sizeof(value);
+        return value;
+    }
+    const std::byte* take(std::size_t size) noexcept {
+        if (m_offset + size > m_size) {
+            m_ok = false;
+            return nullptr;
+        }
+        const std::byte* p = m_data + m_offset;
+        m_offset += size;
+        return p;
+    }
+    void align() noexcept { m_offset = std::min(m_size, align_up(m_offset)); }
+
+    bool ok() const noexcept { return m_ok; }
+
+private:
+    const std::byte* m_data;
+    std::size_t m_size;
+    std::size_t m_offset = 0;
+    bool m_ok = true;
+};
+
+void put_vec2(std::vector<std::byte>& out, struct nk_vec2 v) {
+    put(out, v.x);
+    put(out, v.y);
+}
+
+struct nk_vec2 get_vec2(cursor& in) noexcept {
+    const float x = in.get<float>();
+    const float y = in.get<float>();
+    return nk_vec2(x, y);
+}
+
+void put_input(std::vector<std::byte>& out, const input_snapshot& input) {
+    put_vec2(out, input.mouse_pos);
+    put_vec2(out, input.mouse_prev);
+    put_vec2(out, input.mouse_delta);
+    put_vec2(out, input.scroll_delta);
+    put_bytes(out, input.mouse_down, sizeof(input.mouse_down));
+    put_bytes(out, input.mouse_clicked, sizeof(input.mouse_clicked));
+    for (const struct nk_vec2& pos : input.clicked_pos) {
+        put_vec2(out, pos);
+    }
+    put_bytes(out, input.key_down, sizeof(input.key_down));
+    put_bytes(out, input.key_clicked, sizeof(input.key_clicked));
+    put(out, static_cast<std::uint32_t>(input.text.size()));
+    put_bytes(out, input.text.data(), input.text.size());
+}
+
+void get_input(cursor& in, input_snapshot& input) {
+    input.mouse_pos = get_vec2(in);
+    input.mouse_prev = get_vec2(in);
+    input.mouse_delta = get_vec2(in);
+    input.scroll_delta = get_vec2(in);
+    for (auto& down : input.mouse_down) {
+        down = in.get<std::uint8_t>();
+    }
+    for (auto& clicked : input.mouse_clicked) {
+        clicked = in.get<std::uint8_t>();
+    }
+    for (struct nk_vec2& pos : input.clicked_pos) {
+        pos = get_vec2(in);
+    }
+    for (auto& down : input.key_down) {
+        down = in.get<std::uint8_t>();
+    }
+    for (auto& clicked : input.key_clicked) {
+        clicked = in.get<std::uint8_t>();
+    }
+    const auto length = in.get<std::uint32_t>();
+    const std::byte* text = in.take(length);
+    if (text != nullptr) {
+        input.text.assign(reinterpret_cast<const char*>(text), length);
+    }
+}
+
+std::uint8_t clamp_count(unsigned int count) noexcept {
+    return static_cast<std::uint8_t>(std::min(count, 255u));
+}
+
+} // namespace
+
+input_snapshot input_snapshot::capture(const nk_context* ctx) {
+    const nk_input& in = ctx->input;
+    input_snapshot s;
+    s.mouse_pos = in.mouse.pos;
+    s.mouse_prev = in.mouse.prev;
+    s.mouse_delta = in.mouse.delta;
+    s.scroll_delta = in.mouse.scroll_delta;
+    for (int i = 0; i < NK_BUTTON_MAX; ++i) {
+        s.mouse_down[i] = in.mouse.buttons[i].down != 0;
+        s.mouse_clicked[i] = clamp_count(in.mouse.buttons[i].clicked);
+        s.clicked_pos[i] = in.mouse.buttons[i].clicked_pos;
+    }
+    for (int i = 0; i < NK_KEY_MAX; ++i) {
+        s.key_down[i] = in.keyboard.keys[i].down != 0;
+        s.key_clicked[i] = clamp_count(in.keyboard.keys[i].clicked);
+    }
+    s.text.assign(in.keyboard.text, static_cast<std::size_t>(std::max(in.keyboard.text_len, 0)));
+    return s;
+}
+
+trace_writer::trace_writer(const std::filesystem::path& path, int width, int height)
+    : m_file(path, std::ios::binary | std::ios::trunc), m_start(std::chrono::steady_clock::now()) {
+    m_file.write(trace_magic, sizeof(trace_magic));
+    const std::uint32_t header[3] = {trace_version, static_cast<std::uint32_t>(width),
+                                     static_cast<std::uint32_t>(height)};
+    m_file.write(reinterpret_cast<const char*>(header), sizeof(header));
+}
+
+void trace_writer::write_frame(nk_context* ctx) {
+    m_commands.capture(ctx);
+    write_frame(input_snapshot::capture(ctx), m_commands);
+}
+
+void trace_writer::write_frame(const input_snapshot& input, const command_list& commands) {
+    // フォントの番号を先に決め、初めてのフォントはフレームより前にチャンクとして書く
+    for (const nk_command* cmd : commands) {
+        if (cmd->type == NK_COMMAND_TEXT) {
+            font_id(reinterpret_cast<const nk_command_text*>(cmd)->font);
+        }
+    }
+
+    const auto elapsed = std::chrono::steady_clock::now() - m_start;
+    m_buffer.clear();
+    put(m_buffer, m_frames);
+    const auto time_us = std::chrono::duration_cast<std::chrono::microseconds>(elapsed).count();
+    put(m_buffer, static_cast<std::uint64_t>(time_us));
+    put_input(m_buffer, input);
+    put(m_buffer, static_cast<std::uint32_t>(commands.size()));
+    for (const nk_command* cmd : commands) {
+        m_buffer.resize(align_up(m_buffer.size()));
+        const std::size_t offset = m_buffer.size();
+        const std::size_t size = command_size(cmd);
+        put_bytes(m_buffer, cmd, size);
+        // ポインタは記録したプロセスの外では意味がないので、番号か0に置き換える
+        auto* copy = reinterpret_cast<nk_command*>(m_buffer.data() + offset);
+        copy->next = size;
+        switch (copy->type) {
+        case NK_COMMAND_TEXT: {
+            auto* text = reinterpret_cast<nk_command_text*>(copy);
+            const std::uintptr_t id = font_id(text->font);
+            std::memcpy(&text->font, &id, sizeof(id));
+            break;
+        }
+        case NK_COMMAND_IMAGE:
+            reinterpret_cast<nk_command_image*>(copy)->img.handle = nk_handle_ptr(nullptr);
+            break;
+        case NK_COMMAND_CUSTOM: {
+            auto* custom = reinterpret_cast<nk_command_custom*>(copy);
+            custom->callback = nullptr;
+            custom->callback_data = nk_handle_ptr(nullptr);
+            break;
+        }
+        default:
+            break;
+        }
+    }
+
+    const std::uint32_t chunk_header[2] = {static_cast<std::uint32_t>(chunk::frame),
+                                           static_cast<std::uint32_t>(m_buffer.size())};
+    m_file.write(reinterpret_cast<const char*>(chunk_header), sizeof(chunk_header));
+    m_file.write(reinterpret_cast<const char*>(m_buffer.data()), static_cast<std::streamsize>(m_buffer.size()));
+    ++m_frames;
+}
+
+std::uint32_t trace_writer::font_id(const nk_user_font* font) {
+    const auto it = std::find(m_fonts.begin(), m_fonts.end(), font);
+    if (it != m_fonts.end()) {
+        return static_cast<std::uint32_t>(it - m_fonts.begin());
+    }
+    const auto id = static_cast<std::uint32_t>(m_fonts.size());
+    m_fonts.push_back(font);
+    const std::uint32_t chunk_header[2] = {static_cast<std::uint32_t>(chunk::font), 8};
+    const float height = font != nullptr ? font->height : 0.0f;
+    m_file.write(reinterpret_cast<const char*>(chunk_header), sizeof(chunk_header));
+    m_file.write(reinterpret_cast<const char*>(&id), sizeof(id));
+    m_file.write(reinterpret_cast<const char*>(&height), sizeof(height));
+    return id;
+}
+
+trace_reader::trace_reader(const std::filesystem::path& path) : m_file(path, std::ios::binary) {
+    char magic[4] = {};
+    std::uint32_t header[3] = {};
+    m_file.read(magic, sizeof(magic));
+    m_file.read(reinterpret_cast<char*>(header), sizeof(header));
+    m_valid = m_file && std::memcmp(magic, trace_magic, sizeof(magic)) == 0 && header[0] == trace_version;
+    m_width = static_cast<int>(header[1]);
+    m_height = static_cast<int>(header[2]);
+}
+
+bool trace_reader::next(trace_frame& frame) {
+    while (m_valid) {
+        std::uint32_t chunk_header[2] = {};
+        if (!m_file.read(reinterpret_cast<char*>(chunk_header), sizeof(chunk_header)) ||
+            chunk_header[1] > max_chunk_size) {
+            return false;
+        }
+        m_buffer.resize(chunk_header[1]);
+        if (!m_file.read(reinterpret_cast<char*>(m_buffer.data()), static_cast<std::streamsize>(m_buffer.size()))) {
+            return false;
+        }
+        cursor in(m_buffer.data(), m_buffer.size());
+
+        if (chunk_header[0] == static_cast<std::uint32_t>(chunk::font)) {
+            const auto id = in.get<std::uint32_t>();
+            const auto height = in.get<float>();
+            if (in.ok() && id < (1u << 16)) {
+                m_font_heights.resize(std::max<std::size_t>(m_font_heights.size(), id + 1));
+                m_font_heights[id] = height;
+            }
+            continue;
+        }
+        if (chunk_header[0] != static_cast<std::uint32_t>(chunk::frame)) {
+            // 知らないチャンクは読み飛ばす
+            continue;
+        }
+
+        frame.index = in.get<std::uint64_t>();
+        frame.time_us = in.get<std::uint64_t>();
+        get_input(in, frame.input);
+        const auto count = in.get<std::uint32_t>();
+        frame.commands.clear();
+        for (std::uint32_t i = 0; i < count && in.ok(); ++i) {
+            in.align();
+            // nextには書き込み時にコマンドの大きさを入れてある
+            const std::byte* head = in.take(sizeof(nk_command));
+            if (head == nullptr) {
+                break;
+            }
+            nk_command cmd;
+            std::memcpy(&cmd, head, sizeof(cmd));
+            if (cmd.next < sizeof(nk_command) || in.take(cmd.next - sizeof(nk_command)) == nullptr) {
+                break;
+            }
+            auto* copy = reinterpret_cast<nk_command*>(m_buffer.data() + (head - m_buffer.data()));
+            if (command_size(copy) > cmd.next) {
+                break;
+            }
+            if (copy->type == NK_COMMAND_TEXT) {
+                // フォントの番号をその場で差し替える
+                if (m_font == nullptr) {
+                    continue;
+                }
+                reinterpret_cast<nk_command_text*>(copy)->font = m_font;
+            }
+            frame.commands.append(copy);
+        }
+        return in.ok();
+    }
+    return false;
+}
+
+} // namespace nk
@@ -0,0 +1,522 @@
+// nuklear-impl.cppのNK_IMPLEMENTATIONの後で読み込む
+// nk_draw_list_alloc_vertices等の内部関数を使うので単独ではコンパイルできない
+// NUKLEAR_CPP_NO_SIMDを定義するとスカラーの実装だけを使う
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string_view>
+#include <vector>
+
+#include "nuklear-cpp/draw_data.hpp"
+#include "nuklear-cpp/text_cache.hpp"
+#include "nuklear-cpp/vertex_kernels.hpp"
+
+#if !defined(NUKLEAR_CPP_NO_SIMD) && defined(__AVX2__)
+#include <immintrin.h>
+#define NUKLEAR_CPP_SIMD_AVX2 1
+#elif !defined(NUKLEAR_CPP_NO_SIMD) && (defined(__SSE2__) || defined(_M_X64))
+#include <emmintrin.h>
+#define NUKLEAR_CPP_SIMD_SSE2 1
+#endif
+
+namespace nk {
+
+namespace {
+
+static_assert(sizeof(vertex) == 20 && offsetof(vertex, uv) == 8 && offsetof(vertex, col) == 16,
+              "vertex must match nk_sdl_vertex");
+
+constexpr float aa_size = 1.0f;
+
+// 点から法線方向にscaleだけずらした頂点をcolorで塗る。scaleが0なら点そのもの
+struct fringe {
+    float scale;
+    std::uint32_t color;
+};
+
+// 線分の始点(0)と終点(1)のどちらの頂点から何番目か
+struct corner {
+    unsigned char end;
+    unsigned char offset;
+};
+
+// nk_draw_list_stroke_poly_line/nk_draw_list_fill_poly_convexと同じ三角形の並び
+constexpr corner thin_stroke[] = {
+    {1, 0}, {0, 0}, {0, 2}, {0, 2}, {1, 2}, {1, 0},
+    {1, 1}, {0, 1}, {0, 0}, {0, 0}, {1, 0}, {1, 1},
+};
+constexpr corner thick_stroke[] = {
+    {1, 1}, {0, 1}, {0, 2}, {0, 2}, {1, 2}, {1, 1},
+    {1, 1}, {0, 1}, {0, 0}, {0, 0}, {1, 0}, {1, 1},
+    {1, 2}, {0, 2}, {0, 3}, {0, 3}, {1, 3}, {1, 2},
+};
+constexpr corner fill_fringe[] = {
+    {1, 0}, {0, 0}, {0, 1}, {0, 1}, {1, 1}, {1, 0},
+};
+
+std::uint32_t pack(nk_color color) noexcept {
+    // nk_color → nk_colorf → R8G8B8A8の往復は全ての値で元に戻るので、そのまま詰める
+    std::uint32_t packed;
+    std::memcpy(&packed, &color, sizeof(packed));
+    return packed;
+}
+
+void put(vertex& v, float x, float y, struct nk_vec2 uv, std::uint32_t color) noexcept {
+    v.position[0] = x;
+    v.position[1] = y;
+    v.uv[0] = uv.x;
+    v.uv[1] = uv.y;
+    std::memcpy(v.col, &color, sizeof(color));
+}
+
+// NK_INV_SQRTの既定の実装(nk_inv_sqrt)と同じ近似
+float inv_sqrt(float n) noexcept {
+    const float x2 = n * 0.5f;
+    std::uint32_t i;
+    std::memcpy(&i, &n, sizeof(i));
+    i = 0x5f375A84u - (i >> 1);
+    float f;
+    std::memcpy(&f, &i, sizeof(f));
+    return f * (1.5f - (x2 * f * f));
+}
+
+struct nk_vec2 normal(struct nk_vec2 from, struct nk_vec2 to) noexcept {
+    const float dx = to.x - from.x;
+    const float dy = to.y - from.y;
+    float len = dx * dx + dy * dy;
+    len = len != 0.0f ? inv_sqrt(len) : 1.0f;
+    struct nk_vec2 n;
+    n.x = dy * len;
+    n.y = -(dx * len);
+    return n;
+}
+
+// 隣り合う2本の法線の平均を角の開き具合に応じて伸ばす
+struct nk_vec2 miter(struct nk_vec2 n0, struct nk_vec2 n1, float post) noexcept {
+    struct nk_vec2 dm;
+    dm.x = (n0.x + n1.x) * 0.5f;
+    dm.y = (n0.y + n1.y) * 0.5f;
+    const float dmr2 = dm.x * dm.x + dm.y * dm.y;
+    if (dmr2 > 0.000001f) {
+        float scale = 1.0f / dmr2;
+        scale = NK_MIN(100.0f, scale);
+        dm.x *= scale;
+        dm.y *= scale;
+    }
+    dm.x *= post;
+    dm.y *= post;
+    return dm;
+}
+
+#if defined(NUKLEAR_CPP_SIMD_AVX2)
+// 1レジスタに点を4つ(x, yの順)入れる
+using batch = __m256;
+constexpr std::size_t batch_points = 4;
+inline batch load(const struct nk_vec2* p) noexcept { return _mm256_loadu_ps(&p->x); }
+inline void store(struct nk_vec2* p, batch v) noexcept { _mm256_storeu_ps(&p->x, v); }
+inline batch splat(float v) noexcept { return _mm256_set1_ps(v); }
+inline batch add(batch a, batch b) noexcept { return _mm256_add_ps(a, b); }
+inline batch sub(batch a, batch b) noexcept { return _mm256_sub_ps(a, b); }
+inline batch mul(batch a, batch b) noexcept { return _mm256_mul_ps(a, b); }
+inline batch div(batch a, batch b) noexcept { return _mm256_div_ps(a, b); }
+inline batch min(batch a, batch b) noexcept { return _mm256_min_ps(a, b); }
+inline batch equal(batch a, batch b) noexcept { return _mm256_cmp_ps(a, b, _CMP_EQ_OQ); }
+inline batch greater(batch a, batch b) noexcept { return _mm256_cmp_ps(a, b, _CMP_GT_OQ); }
+inline batch select(batch mask, batch a, batch b) noexcept { return _mm256_blendv_ps(b, a, mask); }
+inline batch swap_xy(batch v) noexcept { return _mm256_permute_ps(v, _MM_SHUFFLE(2, 3, 0, 1)); }
+inline batch negate_y(batch v) noexcept {
+    return _mm256_xor_ps(v, _mm256_setr_ps(0.0f, -0.0f, 0.0f, -0.0f, 0.0f, -0.0f, 0.0f, -0.0f));
+}
+inline batch inv_sqrt(batch n) noexcept {
+    const batch x2 = mul(n, splat(0.5f));
+    const __m256i i = _mm256_sub_epi32(_mm256_set1_epi32(0x5f375A84), _mm256_srli_epi32(_mm256_castps_si256(n), 1));
+    const batch f = _mm256_castsi256_ps(i);
+    return mul(f, sub(splat(1.5f), mul(mul(x2, f), f)));
+}
+#elif defined(NUKLEAR_CPP_SIMD_SSE2)
+// 1レジスタに点を2つ(x, yの順)入れる
+using batch = __m128;
+constexpr std::size_t batch_points = 2;
+inline batch load(const struct nk_vec2* p) noexcept { return _mm_loadu_ps(&p->x); }
+inline void store(struct nk_vec2* p, batch v) noexcept { _mm_storeu_ps(&p->x, v); }
+inline batch splat(float v) noexcept { return _mm_set1_ps(v); }
+inline batch add(batch a, batch b) noexcept { return _mm_add_ps(a, b); }
+inline batch sub(batch a, batch b) noexcept { return _mm_sub_ps(a, b); }
+inline batch mul(batch a, batch b) noexcept { return _mm_mul_ps(a, b); }
+inline batch div(batch a, batch b) noexcept { return _mm_div_ps(a, b); }
+inline batch min(batch a, batch b) noexcept { return _mm_min_ps(a, b); }
+inline batch equal(batch a, batch b) noexcept { return _mm_cmpeq_ps(a, b); }
+inline batch greater(batch a, batch b) noexcept { return _mm_cmpgt_ps(a, b); }
+inline batch select(batch mask, batch a, batch b) noexcept {
+    return _mm_or_ps(_mm_and_ps(mask, a), _mm_andnot_ps(mask, b));
+}
+inline batch swap_xy(batch v) noexcept { return _mm_shuffle_ps(v, v, _MM_SHUFFLE(2, 3, 0, 1)); }
+inline batch negate_y(batch v) noexcept { return _mm_xor_ps(v, _mm_setr_ps(0.0f, -0.0f, 0.0f, -0.0f)); }
+inline batch inv_sqrt(batch n) noexcept {
+    const batch x2 = mul(n, splat(0.5f));
+    const __m128i i = _mm_sub_epi32(_mm_set1_epi32(0x5f375A84), _mm_srli_epi32(_mm_castps_si128(n), 1));
+    const batch f = _mm_castsi128_ps(i);
+    return mul(f, sub(splat(1.5f), mul(mul(x2, f), f)));
+}
+#endif
+
+#if defined(NUKLEAR_CPP_SIMD_AVX2) || defined(NUKLEAR_CPP_SIMD_SSE2)
+// 2つの点(x0, y0, x1, y1)をout[0]とout[stride]へ書く
+// 位置とUVは16バイトで連続しているので1回のストアで書ける
+inline void store_pair(vertex* out, std::size_t stride, __m128 pos, __m128 uv, std::uint32_t color) noexcept {
+    _mm_storeu_ps(reinterpret_cast<float*>(out), _mm_movelh_ps(pos, uv));
+    _mm_storeu_ps(reinterpret_cast<float*>(out + stride), _mm_movehl_ps(uv, pos));
+    std::memcpy(out->col, &color, sizeof(color));
+    std::memcpy(out[stride].col, &color, sizeof(color));
+}
+
+inline void store_vertices(vertex* out, std::size_t stride, batch pos, __m128 uv, std::uint32_t color) noexcept {
+#if defined(NUKLEAR_CPP_SIMD_AVX2)
+    store_pair(out, stride, _mm256_castps256_ps128(pos), uv, color);
+    store_pair(out + 2 * stride, stride, _mm256_extractf128_ps(pos, 1), uv, color);
+#else
+    store_pair(out, stride, pos, uv, color);
+#endif
+}
+#endif
+
+// normals[i]にpoints[i]から次の点(最後は先頭へ戻る)への単位法線を書く
+void segment_normals(const struct nk_vec2* points, std::size_t count, std::size_t points_count,
+                     struct nk_vec2* normals) noexcept {
+    std::size_t i = 0;
+#if defined(NUKLEAR_CPP_SIMD_AVX2) || defined(NUKLEAR_CPP_SIMD_SSE2)
+    // 先頭へ戻る線分は残りのスカラーの処理に回す
+    const std::size_t open = NK_MIN(count, points_count - 1);
+    for (; i + batch_points <= open; i += batch_points) {
+        const batch diff = sub(load(points + i + 1), load(points + i));
+        const batch sq = mul(diff, diff);
+        const batch len = add(sq, swap_xy(sq));
+        const batch inv = select(equal(len, splat(0.0f)), splat(1.0f), inv_sqrt(len));
+        store(normals + i, negate_y(swap_xy(mul(diff, inv))));
+    }
+#endif
+    for (; i < count; ++i) {
+        normals[i] = normal(points[i], points[i + 1 == points_count ? 0 : i + 1]);
+    }
+}
+
+// out[j]に点jの両側の法線から求めた縁の方向を書く
+void miters(const struct nk_vec2* normals, std::size_t first, std::size_t last, std::size_t points_count,
+            float post, struct nk_vec2* out) noexcept {
+    std::size_t j = first;
+    if (j == 0 && j < last) {
+        out[0] = miter(normals[points_count - 1], normals[0], post);
+        ++j;
+    }
+#if defined(NUKLEAR_CPP_SIMD_AVX2) || defined(NUKLEAR_CPP_SIMD_SSE2)
+    for (; j + batch_points <= last; j += batch_points) {
+        batch dm = mul(add(load(normals + j - 1), load(normals + j)), splat(0.5f));
+        const batch sq = mul(dm, dm);
+        const batch dmr2 = add(sq, swap_xy(sq));
+        const batch scale = min(splat(100.0f), div(splat(1.0f), dmr2));
+        dm = select(greater(dmr2, splat(0.000001f)), mul(dm, scale), dm);
+        store(out + j, mul(dm, splat(post)));
+    }
+#endif
+    for (; j < last; ++j) {
+        out[j] = miter(normals[j - 1], normals[j], post);
+    }
+}
+
+// 点ごとにfringes[0..fringe_count)の頂点を続けて書く
+void emit(vertex* out, const struct nk_vec2* points, const struct nk_vec2* offsets, std::size_t count,
+          const fringe* fringes, std::size_t fringe_count, struct nk_vec2 uv) noexcept {
+    std::size_t j = 0;
+#if defined(NUKLEAR_CPP_SIMD_AVX2) || defined(NUKLEAR_CPP_SIMD_SSE2)
+    const __m128 uv2 = _mm_setr_ps(uv.x, uv.y, uv.x, uv.y);
+    for (; j + batch_points <= count; j += batch_points) {
+        const batch p = load(points + j);
+        const batch d = load(offsets + j);
+        for (std::size_t f = 0; f < fringe_count; ++f) {
+            const batch pos = fringes[f].scale == 0.0f ? p : add(p, mul(d, splat(fringes[f].scale)));
+            store_vertices(out + j * fringe_count + f, fringe_count, pos, uv2, fringes[f].color);
+        }
+    }
+#endif
+    for (; j < count; ++j) {
+        for (std::size_t f = 0; f < fringe_count; ++f) {
+            const float s = fringes[f].scale;
+            vertex& v = out[j * fringe_count + f];
+            if (s == 0.0f) {
+                put(v, points[j].x, points[j].y, uv, fringes[f].color);
+            } else {
+                put(v, points[j].x + offsets[j].x * s, points[j].y + offsets[j].y * s, uv, fringes[f].color);
+            }
+        }
+    }
+}
+
+template <std::size_t N>
+nk_draw_index* segment_indices(nk_draw_index* ids, const corner (&pattern)[N], nk_size from, nk_size to) noexcept {
+    for (const corner& c : pattern) {
+        *ids++ = static_cast<nk_draw_index>((c.end ? to : from) + c.offset);
+    }
+    return ids;
+}
+
+// 法線と縁の方向を置く一時領域を頂点バッファの末尾に確保する
+// 確保で頂点バッファが移動することがあるので、vtxは確保後の位置に直す
+struct nk_vec2* alloc_scratch(struct nk_draw_list* list, void*& vtx, nk_size count) {
+    const auto vertex_offset = static_cast<nk_size>(static_cast<nk_byte*>(vtx) -
+                                                    static_cast<nk_byte*>(list->vertices->memory.ptr));
+    nk_buffer_mark(list->vertices, NK_BUFFER_FRONT);
+    auto* scratch = static_cast<struct nk_vec2*>(
+        nk_buffer_alloc(list->vertices, NK_BUFFER_FRONT, sizeof(struct nk_vec2) * count, NK_ALIGNOF(struct nk_vec2)));
+    vtx = static_cast<nk_byte*>(list->vertices->memory.ptr) + vertex_offset;
+    return scratch;
+}
+
+// nk_draw_list_stroke_poly_lineのアンチエイリアスなしの場合と同じ
+void stroke_aliased(struct nk_draw_list* list, const struct nk_vec2* points, nk_size points_count, nk_size count,
+                    std::uint32_t color, float thickness) {
+    nk_size index = list->vertex_count;
+    auto* vtx = static_cast<vertex*>(nk_draw_list_alloc_vertices(list, count * 4));
+    nk_draw_index* ids = nk_draw_list_alloc_elements(list, count * 6);
+    if (!vtx || !ids) return;
+
+    const struct nk_vec2 uv = list->config.tex_null.uv;
+    const float half = thickness * 0.5f;
+    for (nk_size i1 = 0; i1 < count; ++i1) {
+        const struct nk_vec2 p1 = points[i1];
+        const struct nk_vec2 p2 = points[i1 + 1 == points_count ? 0 : i1 + 1];
+        const struct nk_vec2 n = normal(p1, p2);
+        const float ox = n.x * half;
+        const float oy = n.y * half;
+        put(vtx[0], p1.x + ox, p1.y + oy, uv, color);
+        put(vtx[1], p2.x + ox, p2.y + oy, uv, color);
+        put(vtx[2], p2.x - ox, p2.y - oy, uv, color);
+        put(vtx[3], p1.x - ox, p1.y - oy, uv, color);
+        vtx += 4;
+
+        ids[0] = static_cast<nk_draw_index>(index + 0);
+        ids[1] = static_cast<nk_draw_index>(index + 1);
+        ids[2] = static_cast<nk_draw_index>(index + 2);
+        ids[3] = static_cast<nk_draw_index>(index + 0);
+        ids[4] = static_cast<nk_draw_index>(index + 2);
+        ids[5] = static_cast<nk_draw_index>(index + 3);
+        ids += 6;
+        index += 4;
+    }
+}
+
+void stroke_poly_line(struct nk_draw_list* list, const struct nk_vec2* points, nk_size points_count,
+                      nk_color color, nk_draw_list_stroke closed, float thickness, nk_anti_aliasing aliasing) {
+    if (points_count < 2) return;
+
+    const nk_size count = closed ? points_count : points_count - 1;
+    color.a = static_cast<nk_byte>(static_cast<float>(color.a) * list->config.global_alpha);
+    const std::uint32_t solid = pack(color);
+    color.a = 0;
+    const std::uint32_t clear = pack(color);
+
+    if (aliasing != NK_ANTI_ALIASING_ON) {
+        stroke_aliased(list, points, points_count, count, solid, thickness);
+        return;
+    }
+
+    const bool thick = thickness > 1.0f;
+    const nk_size stride = thick ? 4 : 3;
+    const nk_size index = list->vertex_count;
+    void* vtx = nk_draw_list_alloc_vertices(list, points_count * stride);
+    nk_draw_index* ids = nk_draw_list_alloc_elements(list, count * (thick ? 18 : 12));
+    if (!vtx || !ids) return;
+
+    struct nk_vec2* normals = alloc_scratch(list, vtx, points_count * 2);
+    if (!normals) return;
+    struct nk_vec2* offsets = normals + points_count;
+
+    segment_normals(points, count, points_count, normals);
+    if (closed) {
+        miters(normals, 0, points_count, points_count, aa_size, offsets);
+    } else {
+        // 開いた線の両端は線分の法線をそのまま使う
+        normals[points_count - 1] = normals[points_count - 2];
+        offsets[0] = normals[0];
+        miters(normals, 1, points_count, points_count, aa_size, offsets);
+    }
+
+    if (!thick) {
+        const fringe fringes[] = {{0.0f, solid}, {1.0f, clear}, {-1.0f, clear}};
+        emit(static_cast<vertex*>(vtx), points, offsets, points_count, fringes, 3, list->config.tex_null.uv);
+    } else {
+        const float half_inner = (thickness - aa_size) * 0.5f;
+        const fringe fringes[] = {
+            {half_inner + aa_size, clear}, {half_inner, solid}, {-half_inner, solid}, {-(half_inner + aa_size), clear},
+        };
+        emit(static_cast<vertex*>(vtx), points, offsets, points_count, fringes, 4, list->config.tex_null.uv);
+    }
+
+    for (nk_size i1 = 0; i1 < count; ++i1) {
+        const nk_size idx1 = index + i1 * stride;
+        const nk_size idx2 = i1 + 1 == points_count ? index : idx1 + stride;
+        ids = thick ? segment_indices(ids, thick_stroke, idx1, idx2) : segment_indices(ids, thin_stroke, idx1, idx2);
+    }
+
+    // 一時領域を解放する
+    nk_buffer_reset(list->vertices, NK_BUFFER_FRONT);
+}
+
+void fill_poly_convex(struct nk_draw_list* list, const struct nk_vec2* points, nk_size points_count,
+                      nk_color color, nk_anti_aliasing aliasing) {
+    if (points_count < 3) return;
+
+    color.a = static_cast<nk_byte>(static_cast<float>(color.a) * list->config.global_alpha);
+    const std::uint32_t solid = pack(color);
+    color.a = 0;
+    const std::uint32_t clear = pack(color);
+    const nk_size index = list->vertex_count;
+
+    if (aliasing != NK_ANTI_ALIASING_ON) {
+        void* vtx = nk_draw_list_alloc_vertices(list, points_count);
+        nk_draw_index* ids = nk_draw_list_alloc_elements(list, (points_count - 2) * 3);
+        if (!vtx || !ids) return;
+        const fringe fringes[] = {{0.0f, solid}};
+        emit(static_cast<vertex*>(vtx), points, points, points_count, fringes, 1, list->config.tex_null.uv);
+        for (nk_size i = 2; i < points_count; ++i) {
+            ids[0] = static_cast<nk_draw_index>(index);
+            ids[1] = static_cast<nk_draw_index>(index + i - 1);
+            ids[2] = static_cast<nk_draw_index>(index + i);
+            ids += 3;
+        }
+        return;
+    }
+
+    void* vtx = nk_draw_list_alloc_vertices(list, points_count * 2);
+    nk_draw_index* ids = nk_draw_list_alloc_elements(list, (points_count - 2) * 3 + points_count * 6);
+    if (!vtx || !ids) return;
+
+    struct nk_vec2* normals = alloc_scratch(list, vtx, points_count * 2);
+    if (!normals) return;
+    struct nk_vec2* offsets = normals + points_count;
+
+    // 内側の頂点で扇形に塗る
+    for (nk_size i = 2; i < points_count; ++i) {
+        ids[0] = static_cast<nk_draw_index>(index);
+        ids[1] = static_cast<nk_draw_index>(index + ((i - 1) << 1));
+        ids[2] = static_cast<nk_draw_index>(index + (i << 1));
+        ids += 3;
+    }
+
+    segment_normals(points, points_count, points_count, normals);
+    miters(normals, 0, points_count, points_count, aa_size * 0.5f, offsets);
+    const fringe fringes[] = {{-1.0f, solid}, {1.0f, clear}};
+    emit(static_cast<vertex*>(vtx), points, offsets, points_count, fringes, 2, list->config.tex_null.uv);
+
+    // 外周の縁
+    for (nk_size i0 = points_count - 1, i1 = 0; i1 < points_count; i0 = i1++) {
+        ids = segment_indices(ids, fill_fringe, index + (i0 << 1), index + (i1 << 1));
+    }
+
+    nk_buffer_reset(list->vertices, NK_BUFFER_FRONT);
+}
+
+// nk_draw_list_add_textのグリフの四角形を、矩形の左上を原点としてoutに作る
+void glyph_quads(const nk_user_font* font, const char* text, int len, float height, nk_color color,
+                 std::vector<vertex>& out) {
+    const std::uint32_t packed = pack(color);
+    float x = 0.0f;
+    int text_len = 0;
+    nk_rune unicode = 0;
+    nk_rune next = 0;
+    int glyph_len = nk_utf_decode(text, &unicode, len);
+    while (text_len < len && glyph_len) {
+        if (unicode == NK_UTF_INVALID) break;
+
+        const int next_glyph_len = nk_utf_decode(text + text_len + glyph_len, &next, len - text_len);
+        struct nk_user_font_glyph g;
+        font->query(font->userdata, height, &g, unicode, (next == NK_UTF_INVALID) ? '\0' : next);
+
+        const float gx = x + g.offset.x;
+        const float gy = g.offset.y;
+        const std::size_t first = out.size();
+        out.resize(first + 4);
+        put(out[first + 0], gx, gy, g.uv[0], packed);
+        put(out[first + 1], gx + g.width, gy, nk_vec2(g.uv[1].x, g.uv[0].y), packed);
+        put(out[first + 2], gx + g.width, gy + g.height, g.uv[1], packed);
+        put(out[first + 3], gx, gy + g.height, nk_vec2(g.uv[0].x, g.uv[1].y), packed);
+
+        text_len += glyph_len;
+        x += g.xadvance;
+        glyph_len = next_glyph_len;
+        unicode = next;
+    }
+}
+
+// 原点からの頂点をoriginだけずらしてlistへ書き込む
+void emit_quads(struct nk_draw_list* list, const std::vector<vertex>& quads, struct nk_vec2 origin) {
+    if (quads.empty()) return;
+    const nk_size index = list->vertex_count;
+    auto* vtx = static_cast<vertex*>(nk_draw_list_alloc_vertices(list, quads.size()));
+    nk_draw_index* ids = nk_draw_list_alloc_elements(list, quads.size() / 4 * 6);
+    if (!vtx || !ids) return;
+
+    std::memcpy(vtx, quads.data(), quads.size() * sizeof(vertex));
+    for (std::size_t i = 0; i < quads.size(); ++i) {
+        vtx[i].position[0] += origin.x;
+        vtx[i].position[1] += origin.y;
+    }
+    for (nk_size q = index; q < index + quads.size(); q += 4) {
+        ids[0] = static_cast<nk_draw_index>(q + 0);
+        ids[1] = static_cast<nk_draw_index>(q + 1);
+        ids[2] = static_cast<nk_draw_index>(q + 2);
+        ids[3] = static_cast<nk_draw_index>(q + 0);
+        ids[4] = static_cast<nk_draw_index>(q + 2);
+        ids[5] = static_cast<nk_draw_index>(q + 3);
+        ids += 6;
+    }
+}
+
+} // namespace
+
+void stroke_path(nk_draw_list& list, nk_color color, nk_draw_list_stroke closed, float thickness) {
+    const auto* points = static_cast<const struct nk_vec2*>(nk_buffer_memory(list.buffer));
+    stroke_poly_line(&list, points, list.path_count, color, closed, thickness, list.config.line_AA);
+    nk_draw_list_path_clear(&list);
+}
+
+void fill_path(nk_draw_list& list, nk_color color) {
+    const auto* points = static_cast<const struct nk_vec2*>(nk_buffer_memory(list.buffer));
+    fill_poly_convex(&list, points, list.path_count, color, list.config.shape_AA);
+    nk_draw_list_path_clear(&list);
+}
+
+void add_text(nk_draw_list& list, const nk_user_font* font, struct nk_rect rect, const char* text, int len,
+              float height, nk_color color, text_cache* cache) {
+    if (cache == nullptr) {
+        nk_draw_list_add_text(&list, font, rect, text, len, height, color);
+        return;
+    }
+    if (!len || !text) return;
+    if (!NK_INTERSECT(rect.x, rect.y, rect.w, rect.h, list.clip_rect.x, list.clip_rect.y, list.clip_rect.w,
+                      list.clip_rect.h)) {
+        return;
+    }
+
+    nk_draw_list_push_image(&list, font->texture);
+    color.a = static_cast<nk_byte>(static_cast<float>(color.a) * list.config.global_alpha);
+    const std::string_view key(text, static_cast<std::size_t>(len));
+    const text_cache::run* run = cache->find(key, font, height, color);
+    if (run == nullptr) {
+        text_cache::run& created = cache->insert(key, font, height, color);
+        glyph_quads(font, text, len, height, color, created.vertices);
+        run = &created;
+    }
+    emit_quads(&list, run->vertices, nk_vec2(rect.x, rect.y));
+}
+
+const char* vertex_kernel_isa() noexcept {
+#if defined(NUKLEAR_CPP_SIMD_AVX2)
+    return "avx2";
+#elif defined(NUKLEAR_CPP_SIMD_SSE2)
+    return "sse2";
+#else
+    return "scalar";
+#endif
+}
+
+} // namespace nk